@@ -11,7 +11,7 @@ Ticker timer;
 
 void nextEffect() {
   Serial.print("starting next effect\n");
-  ws2811.startEffect(effects[random(0, effects.size())]);
+  ws2811.startEffect(effects[random(0, effects.size())], 2000);  // cross-fade in 2 seconds
 }
 
 void setup() {
@@ -29,6 +29,7 @@ void setup() {
   digitalWrite(23, HIGH);
 
   // start led strip
+  ws2811.setTransitions(true);
   ws2811.begin();
 
   // effect starts in 15 seconds...
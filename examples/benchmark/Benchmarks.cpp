@@ -0,0 +1,280 @@
+/*
+ * Measures the encoder, the colour math and the built-in effects at several string lengths.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <esp32WS2811.h>
+
+#include "Benchmarks.h"
+
+namespace {
+
+const size_t ledCounts[] = {50, 300, 1000, 4000};
+const size_t chunkLeds = 250;  // the RMT items of 4000 leds don't fit in the memory of the ESP32
+const uint32_t ledsPerMeasurement = 200000;
+const uint32_t effectFrames = 250;  // 5 seconds of animation
+
+BenchmarkOutput out = nullptr;
+
+uint32_t runsFor(size_t numLeds) {
+  return ledsPerMeasurement / numLeds;
+}
+
+void report(const char* name, size_t numLeds, uint32_t cycles, uint32_t runs) {
+  double us = cycles / static_cast<double>(getCpuFrequencyMhz()) / runs;
+  char line[160];
+  snprintf(line, sizeof(line), "{\"name\": \"%s\", \"leds\": %u, \"runs\": %u, \"ns_per_led\": %.2f, \"us_per_frame\": %.2f}",
+           name, static_cast<unsigned>(numLeds), static_cast<unsigned>(runs), us * 1000.0 / numLeds, us);
+  out(line);
+}
+
+void fillLeds(Colour* leds, size_t numLeds) {
+  // every byte value appears in every colour channel
+  for (size_t i = 0; i < numLeds; ++i) {
+    leds[i] = Colour(i, i * 7 + 1, i * 13 + 2);
+  }
+}
+
+// Straightforward bit-by-bit encoder, to compare with the lookup table encoder.
+// extras/host/encoder_test.cpp checks that both give the same output.
+void __attribute__((noinline)) referenceItem1(rmt_item32_t* item) {
+  item->level0    = 1;
+  item->duration0 = 10;
+  item->level1    = 0;
+  item->duration1 = 6;
+}
+
+void __attribute__((noinline)) referenceItem0(rmt_item32_t* item) {
+  item->level0    = 1;
+  item->duration0 = 4;
+  item->level1    = 0;
+  item->duration1 = 8;
+}
+
+void referenceEncode(const Colour* leds, size_t count, rmt_item32_t* items) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t currentPixel = leds[i].green << 16 | leds[i].red << 8 | leds[i].blue;
+    for (int8_t j = 23; j >= 0; --j) {
+      if (currentPixel & (1 << j)) {
+        referenceItem1(items);
+      } else {
+        referenceItem0(items);
+      }
+      ++items;
+    }
+  }
+}
+
+// Per component versions of the colour kernels, used as reference
+void referenceAdd(Colour* leds, const Colour* add, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    uint16_t r = leds[i].red + add[i].red;
+    uint16_t g = leds[i].green + add[i].green;
+    uint16_t b = leds[i].blue + add[i].blue;
+    leds[i] = Colour(r > 255 ? 255 : r, g > 255 ? 255 : g, b > 255 ? 255 : b);
+  }
+}
+
+void referenceLerp(Colour* leds, const Colour* from, const Colour* to, size_t count, uint32_t step, uint32_t steps) {
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = Colour(from[i].red + (step * 1.0 / steps) * (to[i].red - from[i].red),
+                     from[i].green + (step * 1.0 / steps) * (to[i].green - from[i].green),
+                     from[i].blue + (step * 1.0 / steps) * (to[i].blue - from[i].blue));
+  }
+}
+
+// The RMT task encodes the whole string, here it is encoded in chunks to limit the memory use
+void benchmarkEncoder(size_t numLeds) {
+  Colour* leds = new Colour[numLeds];
+  rmt_item32_t* reference = new rmt_item32_t[chunkLeds * 24];
+  rmt_item32_t* items = new rmt_item32_t[chunkLeds * 24];
+  uint8_t* error = new uint8_t[numLeds * 3]();
+  fillLeds(leds, numLeds);
+  RmtEncoder encoder;
+  encoder.begin();
+  uint32_t runs = runsFor(numLeds);
+
+  uint32_t start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t first = 0; first < numLeds; first += chunkLeds) {
+      referenceEncode(&leds[first], numLeds - first < chunkLeds ? numLeds - first : chunkLeds, reference);
+    }
+  }
+  report("encode bit loop", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t first = 0; first < numLeds; first += chunkLeds) {
+      encoder.encode(&leds[first], numLeds - first < chunkLeds ? numLeds - first : chunkLeds, items);
+    }
+  }
+  report("encode", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t first = 0; first < numLeds; first += chunkLeds) {
+      encoder.encode(&leds[first], numLeds - first < chunkLeds ? numLeds - first : chunkLeds, items,
+                     &error[first * 3]);
+    }
+  }
+  report("encode dithered", numLeds, ws2811CycleCount() - start, runs);
+
+  delete[] error;
+  delete[] items;
+  delete[] reference;
+  delete[] leds;
+}
+
+void benchmarkHsv(size_t numLeds) {
+  ColourHSV* hsv = new ColourHSV[numLeds];
+  ColourHSV8* hsv8 = new ColourHSV8[numLeds];
+  Colour* leds = new Colour[numLeds];
+  for (size_t i = 0; i < numLeds; ++i) {
+    hsv[i] = ColourHSV(i * 360.0 / numLeds, 80, 70);
+    hsv8[i] = ColourHSV8(i * 256 / numLeds, 204, 178);
+  }
+  uint32_t runs = runsFor(numLeds);
+
+  uint32_t start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t i = 0; i < numLeds; ++i) {
+      leds[i] = hsv[i];
+    }
+  }
+  report("hsv float", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    hsvToRgb(hsv8, leds, numLeds);
+  }
+  report("hsv 8 bit", numLeds, ws2811CycleCount() - start, runs);
+
+  delete[] leds;
+  delete[] hsv8;
+  delete[] hsv;
+}
+
+void benchmarkKernels(size_t numLeds) {
+  Colour* leds = new Colour[numLeds];
+  Colour* from = new Colour[numLeds];
+  Colour* to = new Colour[numLeds];
+  for (size_t i = 0; i < numLeds; ++i) {
+    from[i] = Colour(i, i * 7 + 1, i * 13 + 2);
+    to[i] = Colour(i * 3, 255 - i, i * 5 + 7);
+  }
+  uint32_t runs = runsFor(numLeds);
+
+  uint32_t start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    memcpy(static_cast<void*>(leds), from, numLeds * sizeof(Colour));
+    referenceAdd(leds, to, numLeds);
+  }
+  report("add per component", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    memcpy(static_cast<void*>(leds), from, numLeds * sizeof(Colour));
+    for (size_t i = 0; i < numLeds; ++i) {
+      leds[i] += to[i];
+    }
+  }
+  report("colour +=", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    memcpy(static_cast<void*>(leds), from, numLeds * sizeof(Colour));
+    addBuffers(leds, to, numLeds);
+  }
+  report("addBuffers", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    referenceLerp(leds, from, to, numLeds, run, runs);
+  }
+  report("lerp double", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    lerpBuffers(leds, from, to, numLeds, run * 255 / runs);
+  }
+  report("lerpBuffers", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    scaleBuffer(leds, numLeds, 200);
+  }
+  report("scaleBuffer", numLeds, ws2811CycleCount() - start, runs);
+
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    fadeBuffer(leds, numLeds, 20);
+  }
+  report("fadeBuffer", numLeds, ws2811CycleCount() - start, runs);
+
+  delete[] to;
+  delete[] from;
+  delete[] leds;
+}
+
+// One number per led, like Circus every frame
+void benchmarkRandom(size_t numLeds) {
+  uint8_t* values = new uint8_t[numLeds];
+  uint32_t runs = runsFor(numLeds);
+
+  uint32_t start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t i = 0; i < numLeds; ++i) {
+      values[i] = random(0, 12);
+    }
+  }
+  report("arduino random", numLeds, ws2811CycleCount() - start, runs);
+
+  EffectRandom effectRandom(1);
+  start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    for (size_t i = 0; i < numLeds; ++i) {
+      values[i] = effectRandom.between(0, 12);
+    }
+  }
+  report("EffectRandom", numLeds, ws2811CycleCount() - start, runs);
+
+  delete[] values;
+}
+
+// Renders on a virtual clock at 50 fps, seeded so every run renders the same frames
+void benchmarkEffect(const char* name, WS2811Effect* effect, size_t numLeds) {
+  Colour* leds = new Colour[numLeds];
+  OfflineRenderer renderer(leds, numLeds, 50);
+  effect->seed(1);
+  renderer.start(effect);
+  uint32_t runs = effectFrames;
+
+  uint32_t start = ws2811CycleCount();
+  for (uint32_t run = 0; run < runs; ++run) {
+    renderer.renderFrame();
+  }
+  report(name, numLeds, ws2811CycleCount() - start, runs);
+
+  renderer.stop();
+  delete effect;
+  delete[] leds;
+}
+
+}  // namespace
+
+void runBenchmarks(BenchmarkOutput output) {
+  out = output;
+  for (size_t numLeds : ledCounts) {
+    benchmarkEncoder(numLeds);
+    benchmarkHsv(numLeds);
+    benchmarkKernels(numLeds);
+    benchmarkRandom(numLeds);
+    benchmarkEffect("Circus", new Circus(20), numLeds);  // new colours every frame
+    benchmarkEffect("SnowSparkle", new SnowSparkle({82, 56, 13}, numLeds / 10, 100, 500), numLeds);
+    benchmarkEffect("Aurora", new Aurora, numLeds);
+    // a new transition every 120 ms, before the last one is done, so every frame but the first few does a step
+    benchmarkEffect("Autumn", new Autumn(1000, 100), numLeds);
+  }
+}
@@ -0,0 +1,11 @@
+/*
+ * Benchmark suite of the library, shared by the benchmark sketch and the host build.
+ * Every result is printed as a JSON object on its own line (JSON Lines) so runs of
+ * different commits can be diffed and compared by scripts.
+ */
+
+#pragma once
+
+typedef void (*BenchmarkOutput)(const char* line);
+
+void runBenchmarks(BenchmarkOutput output);
@@ -0,0 +1,21 @@
+/*
+ * Measures the performance of the library's building blocks on the target.
+ * Results are printed on the serial port, one JSON object per line.
+ * The same benchmarks run on a computer with the host build in extras/host.
+ */
+
+#include <Arduino.h>
+
+#include <esp32WS2811.h>
+
+#include "Benchmarks.h"
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  runBenchmarks([](const char* line) { Serial.println(line); });
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,140 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <thread>
+
+#include <esp32-hal-log.h>
+
+#include "CaptureOutput.h"
+
+CaptureOutput::CaptureOutput() :
+  _mutex(),
+  _config(),
+  _items(),
+  _scratch(),
+  _onFrame(),
+  _realtime(false),
+  _frames(0),
+  _frameTicks(0) {}
+
+bool CaptureOutput::begin(const WS2811OutputConfig& config) {
+  _config = config;
+  return true;
+}
+
+void CaptureOutput::end() {}
+
+void CaptureOutput::write(const rmt_item32_t* items, size_t numItems) {
+  // the terminator is kept, it belongs to the frame time like on the wire
+  if (numItems == 0 || items[numItems - 1].level0 != 0 || items[numItems - 1].duration1 != 0) {
+    log_e("last item is not a terminator");
+  }
+  _capture(items, numItems);
+}
+
+void CaptureOutput::writeSample(const uint8_t* data, size_t size) {
+  // every item holds one bit, the translator is asked for the free memory
+  _scratch.resize(size * 8);
+  size_t wanted = _config.memBlocks * 64;
+  size_t translated = 0;
+  size_t numItems = 0;
+  while (translated < size) {
+    size_t translatedSize = 0;
+    size_t itemNum = 0;
+    _config.translator(data + translated, &_scratch[numItems], size - translated, wanted,
+                       &translatedSize, &itemNum);
+    if (translatedSize == 0) break;
+    translated += translatedSize;
+    numItems += itemNum;
+    wanted = _config.memBlocks * 64 / 2;
+  }
+  _capture(_scratch.data(), numItems);
+}
+
+void CaptureOutput::waitDone() {
+  if (!_realtime) return;
+  // one tick is clkDiv / 80 cycles of a microsecond
+  uint64_t ns = _frameTicks * _config.clkDiv * 1000 / (APB_CLK_FREQ / 1000000);
+  std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+}
+
+void CaptureOutput::setRealtime(bool enable) {
+  _realtime = enable;
+}
+
+void CaptureOutput::onFrame(std::function<void(const rmt_item32_t* items, size_t numItems)> callback) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _onFrame = callback;
+}
+
+uint32_t CaptureOutput::frames() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _frames;
+}
+
+std::vector<rmt_item32_t> CaptureOutput::lastFrame() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _items;
+}
+
+uint32_t CaptureOutput::frameUs() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return static_cast<uint32_t>(_frameTicks * _config.clkDiv / (APB_CLK_FREQ / 1000000));
+}
+
+size_t CaptureOutput::decode(const LedTiming& timing, uint8_t* bytes, size_t size) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  // a 1 bit has the longer high time
+  uint32_t threshold = (timing.t0h + timing.t1h) / 2;
+  size_t numBytes = _items.size() / 8 < size ? _items.size() / 8 : size;
+  for (size_t i = 0; i < numBytes; ++i) {
+    uint8_t value = 0;
+    for (size_t bit = 0; bit < 8; ++bit) {
+      value = (value << 1) | (_items[i * 8 + bit].duration0 > threshold ? 1 : 0);
+    }
+    bytes[i] = value;
+  }
+  return numBytes;
+}
+
+void CaptureOutput::_capture(const rmt_item32_t* items, size_t numItems) {
+  std::function<void(const rmt_item32_t* items, size_t numItems)> onFrame;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _items.assign(items, items + numItems);
+    _frameTicks = 0;
+    for (size_t i = 0; i < numItems; ++i) {
+      _frameTicks += items[i].duration0 + items[i].duration1;
+    }
+    ++_frames;
+    onFrame = _onFrame;
+  }
+  if (onFrame) onFrame(items, numItems);
+}
+
+WS2811Output* ws2811DefaultOutput(rmt_channel_t channel) {
+  static CaptureOutput outputs[RMT_CHANNEL_MAX];
+  return &outputs[channel];
+}
@@ -0,0 +1,156 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+Converts raw frame dumps into the animation format of AnimationFormat.h, to play with AnimationPlayer.
+
+Usage: ws2811_animation <numLeds> <fps> <input> <output> [keyframeInterval] [--rgbw]
+
+The input holds the frames one after the other, every led as 3 bytes (RGB) or 4 bytes (RGBW).
+A key frame is written every keyframeInterval frames (defaults to one per second) and whenever it
+is smaller than the delta.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <Effects/AnimationFormat.h>
+
+namespace {
+
+void addRun(std::vector<uint8_t>* out, uint8_t type, size_t count) {
+  out->push_back(type | (count - 1));
+}
+
+// Encodes the leds in [first, end), leds that equal the previous frame are skipped in a delta
+void encodeFrame(const uint8_t* frame, const uint8_t* previous, size_t numLeds, size_t bytesPerLed,
+                 bool key, std::vector<uint8_t>* out) {
+  auto same = [&](const uint8_t* a, size_t i, const uint8_t* b, size_t j) {
+    return memcmp(&a[i * bytesPerLed], &b[j * bytesPerLed], bytesPerLed) == 0;
+  };
+  auto changed = [&](size_t i) { return key || !same(frame, i, previous, i); };
+  size_t first = 0;
+  size_t end = numLeds;
+  if (!key) {
+    while (first < numLeds && !changed(first)) ++first;
+    while (end > first && !changed(end - 1)) --end;
+  }
+  out->push_back(key ? AnimationFormat::KEY : AnimationFormat::DELTA);
+  uint8_t range[8];
+  AnimationFormat::writeUint32(&range[0], first);
+  AnimationFormat::writeUint32(&range[4], end);
+  out->insert(out->end(), range, range + 8);
+
+  size_t led = first;
+  while (led < end) {
+    size_t count = 1;
+    if (!changed(led)) {
+      while (led + count < end && count < AnimationFormat::MAX_RUN && !changed(led + count)) ++count;
+      addRun(out, AnimationFormat::SKIP, count);
+    } else if (led + 1 < end && same(frame, led, frame, led + 1)) {
+      while (led + count < end && count < AnimationFormat::MAX_RUN && same(frame, led, frame, led + count)) ++count;
+      addRun(out, AnimationFormat::REPEAT, count);
+      out->insert(out->end(), &frame[led * bytesPerLed], &frame[(led + 1) * bytesPerLed]);
+    } else {
+      // a literal ends where a skip or a repeat of 2 or more leds starts
+      while (led + count < end && count < AnimationFormat::MAX_RUN && changed(led + count) &&
+             !(led + count + 1 < end && same(frame, led + count, frame, led + count + 1))) {
+        ++count;
+      }
+      addRun(out, AnimationFormat::LITERAL, count);
+      out->insert(out->end(), &frame[led * bytesPerLed], &frame[(led + count) * bytesPerLed]);
+    }
+    led += count;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 5) {
+    fprintf(stderr, "usage: %s <numLeds> <fps> <input> <output> [keyframeInterval] [--rgbw]\n", argv[0]);
+    return 1;
+  }
+  AnimationFormat::Header header;
+  header.numLeds = strtoul(argv[1], nullptr, 10);
+  header.fps = strtoul(argv[2], nullptr, 10);
+  header.bytesPerLed = 3;
+  header.numFrames = 0;
+  uint32_t keyframeInterval = header.fps;
+  for (int i = 5; i < argc; ++i) {
+    if (strcmp(argv[i], "--rgbw") == 0) {
+      header.bytesPerLed = 4;
+    } else {
+      keyframeInterval = strtoul(argv[i], nullptr, 10);
+    }
+  }
+  if (header.numLeds == 0 || header.fps == 0 || keyframeInterval == 0) {
+    fprintf(stderr, "number of leds, fps and keyframe interval have to be at least 1\n");
+    return 1;
+  }
+  FILE* input = fopen(argv[3], "rb");
+  FILE* output = fopen(argv[4], "wb");
+  if (!input || !output) {
+    fprintf(stderr, "could not open %s\n", input ? argv[4] : argv[3]);
+    return 1;
+  }
+
+  uint8_t headerData[AnimationFormat::HEADER_SIZE];
+  AnimationFormat::writeHeader(headerData, header);  // rewritten with the number of frames at the end
+  fwrite(headerData, 1, sizeof(headerData), output);
+
+  size_t frameSize = header.numLeds * header.bytesPerLed;
+  std::vector<uint8_t> frame(frameSize);
+  std::vector<uint8_t> previous(frameSize);
+  std::vector<uint8_t> key;
+  std::vector<uint8_t> delta;
+  size_t rawSize = 0;
+  size_t encodedSize = sizeof(headerData);
+  while (fread(frame.data(), 1, frameSize, input) == frameSize) {
+    key.clear();
+    encodeFrame(frame.data(), previous.data(), header.numLeds, header.bytesPerLed, true, &key);
+    const std::vector<uint8_t>* encoded = &key;
+    if (header.numFrames % keyframeInterval != 0) {
+      delta.clear();
+      encodeFrame(frame.data(), previous.data(), header.numLeds, header.bytesPerLed, false, &delta);
+      if (delta.size() < key.size()) encoded = &delta;
+    }
+    fwrite(encoded->data(), 1, encoded->size(), output);
+    rawSize += frameSize;
+    encodedSize += encoded->size();
+    previous.swap(frame);
+    ++header.numFrames;
+  }
+
+  AnimationFormat::writeHeader(headerData, header);
+  fseek(output, 0, SEEK_SET);
+  fwrite(headerData, 1, sizeof(headerData), output);
+  fclose(output);
+  fclose(input);
+  printf("%u frames, %u bytes raw, %u bytes encoded\n", static_cast<unsigned>(header.numFrames),
+         static_cast<unsigned>(rawSize), static_cast<unsigned>(encodedSize));
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+/*
+Compares the lookup table encoder with a bit-by-bit reference encoder, for every byte value
+in every colour component and every pixel format, and checks that brightness and colour
+correction of 0 turn the leds off.
+
+Usage: ws2811_encoder_test, returns 0 when all checks pass
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <esp32WS2811.h>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* name, const char* what) {
+  if (!condition) {
+    printf("FAIL %s: %s\n", name, what);
+    ++failures;
+  }
+}
+
+// Straightforward bit-by-bit encoder, most significant bit first
+template <class Format>
+void referenceEncode(const Colour* leds, size_t count, const LedTiming& timing, rmt_item32_t* items) {
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t byte = 0; byte < Format::BYTES_PER_LED; ++byte) {
+      uint8_t value = Format::byte(leds[i], byte);
+      for (int8_t bit = 7; bit >= 0; --bit) {
+        bool one = value & (1 << bit);
+        items->level0    = 1;
+        items->duration0 = one ? timing.t1h : timing.t0h;
+        items->level1    = 0;
+        items->duration1 = one ? timing.t1l : timing.t0l;
+        ++items;
+      }
+    }
+  }
+}
+
+// 256 leds, every component takes every byte value once
+void fillLeds(Colour* leds) {
+  for (size_t i = 0; i < 256; ++i) {
+    leds[i] = Colour(i, 255 - i, i * 7, i * 13 + 5);
+  }
+}
+
+template <class Format>
+void testFormat(const char* name, const LedTiming& timing) {
+  Colour leds[256];
+  fillLeds(leds);
+  const size_t numItems = 256 * Format::BYTES_PER_LED * 8;
+  rmt_item32_t* reference = new rmt_item32_t[numItems];
+  rmt_item32_t* items = new rmt_item32_t[numItems];
+  referenceEncode<Format>(leds, 256, timing, reference);
+
+  RmtEncoder encoder;
+  encoder.setFormat<Format>();
+  encoder.begin(timing);
+  check(encoder.bytesPerLed() == Format::BYTES_PER_LED, name, "bytes per led");
+
+  memset(static_cast<void*>(items), 0, numItems * sizeof(rmt_item32_t));
+  encoder.encode(leds, 256, items);
+  check(memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0, name, "encode");
+
+  // chunks which start and end halfway a led, like the streaming mode
+  memset(static_cast<void*>(items), 0, numItems * sizeof(rmt_item32_t));
+  const size_t numBytes = 256 * Format::BYTES_PER_LED;
+  for (size_t first = 0; first < numBytes; first += 7) {
+    size_t count = numBytes - first < 7 ? numBytes - first : 7;
+    encoder.encodeBytes(leds, first, count, &items[first * 8]);
+  }
+  check(memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0, name, "encodeBytes");
+
+  // dithering without corrections has no fraction to carry
+  uint8_t error[256 * 4] = {};
+  memset(static_cast<void*>(items), 0, numItems * sizeof(rmt_item32_t));
+  encoder.encode(leds, 256, items, error);
+  check(memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0, name, "encode dithered");
+
+  delete[] items;
+  delete[] reference;
+}
+
+// Brightness and colour correction of 0 turn the leds off, also with dithering
+void testOff() {
+  Colour leds[256];
+  fillLeds(leds);
+  Colour expected[256];
+  const size_t numItems = 256 * 24;
+  rmt_item32_t* reference = new rmt_item32_t[numItems];
+  rmt_item32_t* items = new rmt_item32_t[numItems];
+  uint8_t error[256 * 3] = {};
+  RmtEncoder encoder;
+  encoder.begin();
+
+  encoder.setBrightness(0);
+  referenceEncode<PixelFormats::GRB>(expected, 256, LedTimings::DEFAULT, reference);
+  bool off = true;
+  for (size_t frame = 0; frame < 256; ++frame) {
+    encoder.encode(leds, 256, items, error);
+    off = off && memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0;
+  }
+  check(off, "brightness 0", "leds are lit");
+
+  // full brightness and correction keep the colour, a correction of 0 turns a component off
+  encoder.setBrightness(255);
+  encoder.setColourCorrection(Colour(255, 0, 0));
+  for (size_t i = 0; i < 256; ++i) {
+    expected[i] = Colour(leds[i].red, 0, 0);
+  }
+  referenceEncode<PixelFormats::GRB>(expected, 256, LedTimings::DEFAULT, reference);
+  encoder.encode(leds, 256, items);
+  check(memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0, "correction 0", "encode");
+  memset(error, 0, sizeof(error));
+  off = true;
+  for (size_t frame = 0; frame < 256; ++frame) {
+    encoder.encode(leds, 256, items, error);
+    off = off && memcmp(items, reference, numItems * sizeof(rmt_item32_t)) == 0;
+  }
+  check(off, "correction 0", "encode dithered");
+
+  delete[] items;
+  delete[] reference;
+}
+
+template <class Format>
+void testFormat(const char* name) {
+  testFormat<Format>(name, LedTimings::DEFAULT);
+  testFormat<Format>(name, LedTimings::WS2811_400KHZ);
+}
+
+}  // namespace
+
+int main() {
+  testFormat<PixelFormats::GRB>("GRB");
+  testFormat<PixelFormats::RGB>("RGB");
+  testFormat<PixelFormats::BRG>("BRG");
+  testFormat<PixelFormats::RBG>("RBG");
+  testFormat<PixelFormats::GBR>("GBR");
+  testFormat<PixelFormats::BGR>("BGR");
+  testFormat<PixelFormats::GRBW>("GRBW");
+  testFormat<PixelFormats::RGBW>("RGBW");
+  testOff();
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file CaptureOutput.h
+ * @brief Output for the host build that keeps the RMT items of the last frame
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <driver/rmt.h>
+
+#include "WS2811Output.h"
+#include "LedTiming.h"
+
+/**
+ * @brief Captures the RMT items that would be sent to the leds.
+ * 
+ * Streaming mode is simulated the way the RMT driver does it: the translator first fills all
+ * memory blocks and then refills half of the memory at a time.
+ */
+class CaptureOutput : public WS2811Output {
+ public:
+  CaptureOutput();
+  bool begin(const WS2811OutputConfig& config) override;
+  void end() override;
+  void write(const rmt_item32_t* items, size_t numItems) override;
+  void writeSample(const uint8_t* data, size_t size) override;
+  void waitDone() override;
+
+  /**
+   * @brief Take as long as the leds to send a frame. Off by default, frames are sent instantly.
+   */
+  void setRealtime(bool enable);
+
+  /**
+   * @brief Called from the RMT task with the items of every frame that is sent.
+   */
+  void onFrame(std::function<void(const rmt_item32_t* items, size_t numItems)> callback);
+
+  /**
+   * @brief Returns the number of frames sent.
+   */
+  uint32_t frames() const;
+
+  /**
+   * @brief Returns a copy of the items of the last frame.
+   * 
+   * In buffered mode the last item is the terminator. The RMT driver doesn't send one in
+   * streaming mode, the string waits for the reset time instead.
+   */
+  std::vector<rmt_item32_t> lastFrame() const;
+
+  /**
+   * @brief Returns the time the leds need to receive the last frame, in microseconds, including
+   * the terminator.
+   */
+  uint32_t frameUs() const;
+
+  /**
+   * @brief Decode the bytes of the last frame, as the leds would receive them.
+   * 
+   * @param timing timing the string was set up with
+   * @param bytes destination
+   * @param size maximum number of bytes to decode
+   * @return number of bytes decoded
+   */
+  size_t decode(const LedTiming& timing, uint8_t* bytes, size_t size) const;
+
+ private:
+  void _capture(const rmt_item32_t* items, size_t numItems);
+  mutable std::mutex _mutex;
+  WS2811OutputConfig _config;
+  std::vector<rmt_item32_t> _items;
+  std::vector<rmt_item32_t> _scratch;
+  std::function<void(const rmt_item32_t* items, size_t numItems)> _onFrame;
+  bool _realtime;
+  uint32_t _frames;
+  uint64_t _frameTicks;
+};
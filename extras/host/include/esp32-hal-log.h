@@ -0,0 +1,55 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file esp32-hal-log.h
+ * @brief Host shim of the Arduino log macros, printed to stderr
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#define ARDUHAL_LOG_LEVEL_NONE 0
+#define ARDUHAL_LOG_LEVEL_ERROR 1
+#define ARDUHAL_LOG_LEVEL_WARN 2
+#define ARDUHAL_LOG_LEVEL_INFO 3
+#define ARDUHAL_LOG_LEVEL_DEBUG 4
+#define ARDUHAL_LOG_LEVEL_VERBOSE 5
+
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL ARDUHAL_LOG_LEVEL_WARN
+#endif
+
+#define ARDUHAL_LOG(level, letter, format, ...) \
+  do { \
+    if (CORE_DEBUG_LEVEL >= level) \
+      fprintf(stderr, "[" letter "][%s:%d] %s(): " format "\n", __FILE__, __LINE__, __func__, ##__VA_ARGS__); \
+  } while (0)
+
+#define log_e(format, ...) ARDUHAL_LOG(ARDUHAL_LOG_LEVEL_ERROR, "E", format, ##__VA_ARGS__)
+#define log_w(format, ...) ARDUHAL_LOG(ARDUHAL_LOG_LEVEL_WARN, "W", format, ##__VA_ARGS__)
+#define log_i(format, ...) ARDUHAL_LOG(ARDUHAL_LOG_LEVEL_INFO, "I", format, ##__VA_ARGS__)
+#define log_d(format, ...) ARDUHAL_LOG(ARDUHAL_LOG_LEVEL_DEBUG, "D", format, ##__VA_ARGS__)
+#define log_v(format, ...) ARDUHAL_LOG(ARDUHAL_LOG_LEVEL_VERBOSE, "V", format, ##__VA_ARGS__)
@@ -0,0 +1,62 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+Runs an effect on a simulated string and prints the statistics of the string.
+
+Usage: ws2811_host [numLeds] [seconds]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <esp32WS2811.h>
+#include <CaptureOutput.h>
+
+int main(int argc, char* argv[]) {
+  size_t numLeds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 300;
+  uint32_t seconds = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2;
+
+  CaptureOutput output;
+  output.setRealtime(true);
+  WS2811 ws2811(18, numLeds);
+  ws2811.setOutput(&output);
+  ws2811.begin();
+
+  Aurora aurora;
+  ws2811.startEffect(&aurora);
+  delay(seconds * 1000);
+  ws2811.stopEffect();
+
+  uint8_t first[3] = {0, 0, 0};
+  output.decode(LedTimings::DEFAULT, first, sizeof(first));
+  WS2811Stats stats = ws2811.getStats();
+  printf("leds: %u, frames: %u, coalesced: %u, lock timeouts: %u\n", static_cast<unsigned>(numLeds),
+         stats.frames, stats.coalesced, stats.lockTimeouts);
+  printf("render: %u us avg, %u us max\n", stats.render.average(), stats.render.max);
+  printf("encode: %u us avg, %u us max\n", stats.encode.average(), stats.encode.max);
+  printf("transmit: %u us avg, wire time %u us\n", stats.transmit.average(), output.frameUs());
+  printf("first led: %02x %02x %02x\n", first[0], first[1], first[2]);
+  return 0;
+}
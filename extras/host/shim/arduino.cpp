@@ -0,0 +1,95 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <hal/cpu_hal.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t CPU_FREQUENCY_MHZ = 240;
+
+Clock::time_point bootTime() {
+  static Clock::time_point boot = Clock::now();
+  return boot;
+}
+
+std::mutex randomMutex;
+std::mt19937 randomEngine;
+
+}  // namespace
+
+int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime()).count();
+}
+
+uint32_t cpu_hal_get_cycle_count() {
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - bootTime()).count();
+  return static_cast<uint32_t>(ns * CPU_FREQUENCY_MHZ / 1000);
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return CPU_FREQUENCY_MHZ;
+}
+
+uint32_t millis() {
+  return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+uint32_t micros() {
+  return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+void delay(uint32_t ms) {
+  vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  std::lock_guard<std::mutex> lock(randomMutex);
+  return static_cast<long>(randomEngine() % static_cast<uint32_t>(howbig));
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  std::lock_guard<std::mutex> lock(randomMutex);
+  randomEngine.seed(static_cast<uint32_t>(seed));
+}
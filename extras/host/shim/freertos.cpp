@@ -0,0 +1,240 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+// A deleted task never runs again: it parks at its next blocking call and its thread is leaked.
+struct tskTaskControlBlock {
+  uint32_t notifications;
+  bool blocked;
+  bool deleted;
+};
+
+struct QueueDefinition {
+  UBaseType_t count;
+};
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// never destroyed, parked threads still wait on them when the program exits
+std::mutex& schedulerMutex() {
+  static std::mutex* mutex = new std::mutex;
+  return *mutex;
+}
+
+std::condition_variable& schedulerCv() {
+  static std::condition_variable* cv = new std::condition_variable;
+  return *cv;
+}
+
+std::recursive_mutex& criticalMutex() {
+  static std::recursive_mutex* mutex = new std::recursive_mutex;
+  return *mutex;
+}
+
+Clock::time_point bootTime() {
+  static Clock::time_point boot = Clock::now();
+  return boot;
+}
+
+Clock::time_point tickTime(TickType_t tick) {
+  return bootTime() + std::chrono::milliseconds(tick * portTICK_PERIOD_MS);
+}
+
+thread_local tskTaskControlBlock* currentTask = nullptr;
+
+tskTaskControlBlock* self() {
+  if (!currentTask) currentTask = new tskTaskControlBlock{0, false, false};  // thread not created by xTaskCreate
+  return currentTask;
+}
+
+void park(std::unique_lock<std::mutex>* lock) {
+  while (true) schedulerCv().wait(*lock);
+}
+
+// returns false when the deadline passes before ready() is true
+template <class Ready>
+bool blockUntil(std::unique_lock<std::mutex>* lock, TickType_t ticksToWait, Clock::time_point deadline,
+                Ready ready) {
+  tskTaskControlBlock* task = self();
+  task->blocked = true;
+  schedulerCv().notify_all();  // vTaskDelete() waits for the task to block
+  auto wake = [&]() { return task->deleted || ready(); };
+  if (ticksToWait == portMAX_DELAY) {
+    schedulerCv().wait(*lock, wake);
+  } else {
+    schedulerCv().wait_until(*lock, deadline, wake);
+  }
+  if (task->deleted) park(lock);
+  task->blocked = false;
+  return ready();
+}
+
+Clock::time_point deadlineIn(TickType_t ticks) {
+  return Clock::now() + std::chrono::milliseconds(ticks == portMAX_DELAY ? 0 : ticks * portTICK_PERIOD_MS);
+}
+
+}  // namespace
+
+void portENTER_CRITICAL(portMUX_TYPE* mux) {
+  criticalMutex().lock();
+  ++mux->count;
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE* mux) {
+  --mux->count;
+  criticalMutex().unlock();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  (void)core;
+  bootTime();
+  tskTaskControlBlock* task = new tskTaskControlBlock{0, false, false};
+  if (handle) *handle = task;
+  std::thread([task, function, parameters]() {
+    currentTask = task;
+    function(parameters);
+    // a FreeRTOS task may not return, treat it as deleting itself
+    std::unique_lock<std::mutex> lock(schedulerMutex());
+    task->blocked = true;
+    task->deleted = true;
+    schedulerCv().notify_all();
+    park(&lock);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  std::unique_lock<std::mutex> lock(schedulerMutex());
+  if (!task || task == self()) {
+    self()->blocked = true;
+    self()->deleted = true;
+    schedulerCv().notify_all();
+    park(&lock);
+  }
+  task->deleted = true;
+  schedulerCv().notify_all();
+  schedulerCv().wait(lock, [task]() { return task->blocked; });
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return self();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(schedulerMutex());
+  ++task->notifications;
+  schedulerCv().notify_all();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedulerMutex());
+  tskTaskControlBlock* task = self();
+  blockUntil(&lock, ticksToWait, deadlineIn(ticksToWait), [task]() { return task->notifications > 0; });
+  uint32_t value = task->notifications;
+  if (value) task->notifications = clearCountOnExit ? 0 : value - 1;
+  return value;
+}
+
+TickType_t xTaskGetTickCount() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - bootTime()).count() /
+         portTICK_PERIOD_MS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(schedulerMutex());
+  blockUntil(&lock, ticks, deadlineIn(ticks), []() { return false; });
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t timeIncrement) {
+  *previousWakeTime += timeIncrement;
+  std::unique_lock<std::mutex> lock(schedulerMutex());
+  blockUntil(&lock, timeIncrement, tickTime(*previousWakeTime), []() { return false; });
+}
+
+void vTaskSetTimeOutState(TimeOut_t* timeOut) {
+  timeOut->entered = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* timeOut, TickType_t* ticksToWait) {
+  if (*ticksToWait == portMAX_DELAY) return pdFALSE;
+  TickType_t now = xTaskGetTickCount();
+  TickType_t elapsed = now - timeOut->entered;
+  if (elapsed >= *ticksToWait) {
+    *ticksToWait = 0;
+    return pdTRUE;
+  }
+  *ticksToWait -= elapsed;
+  timeOut->entered = now;
+  return pdFALSE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return new QueueDefinition{0};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new QueueDefinition{1};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedulerMutex());
+  if (!blockUntil(&lock, ticksToWait, deadlineIn(ticksToWait), [semaphore]() { return semaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  --semaphore->count;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(schedulerMutex());
+  if (semaphore->count > 0) return pdFALSE;
+  ++semaphore->count;
+  schedulerCv().notify_all();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
@@ -0,0 +1,123 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file AnimationFormat.h
+ * @brief Binary format of pre-rendered animations
+ *
+ * All numbers are little endian. A file starts with a header:
+ *
+ *     offset  size  field
+ *     0       4     magic "WSAN"
+ *     4       1     version, 1
+ *     5       1     bytes per led: 3 for RGB, 4 for RGBW
+ *     6       2     frames per second
+ *     8       4     number of leds
+ *     12      4     number of frames
+ *
+ * Every frame starts with its type (key or delta) and the range of leds [first, end) it changes,
+ * followed by runs that fill that range:
+ *
+ *     0       1     type
+ *     1       4     first
+ *     5       4     end
+ *
+ * A run is one byte with the run type in the 2 high bits and the number of leds - 1 (1-64) in the
+ * 6 low bits. SKIP keeps the leds of the previous frame, LITERAL is followed by the colour of every
+ * led and REPEAT by one colour for all leds. Key frames don't skip and hold the whole string, so
+ * playback can start from them. The first frame is always a key frame.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace AnimationFormat {
+
+const uint8_t VERSION = 1;
+const size_t HEADER_SIZE = 16;
+const size_t FRAME_HEADER_SIZE = 9;
+const size_t MAX_RUN = 64;
+
+enum FrameType : uint8_t {
+  KEY = 0,
+  DELTA = 1
+};
+
+enum RunType : uint8_t {
+  SKIP = 0x00,
+  LITERAL = 0x40,
+  REPEAT = 0x80,
+  RUN_TYPE_MASK = 0xC0
+};
+
+struct Header {
+  uint8_t bytesPerLed;
+  uint16_t fps;
+  uint32_t numLeds;
+  uint32_t numFrames;
+};
+
+inline uint32_t readUint32(const uint8_t* data) {
+  return data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+inline void writeUint32(uint8_t* data, uint32_t value) {
+  data[0] = value;
+  data[1] = value >> 8;
+  data[2] = value >> 16;
+  data[3] = value >> 24;
+}
+
+/**
+ * @brief Parse the header at the start of a file.
+ * 
+ * @return false when the data isn't a supported animation
+ */
+inline bool readHeader(const uint8_t* data, Header* header) {
+  if (data[0] != 'W' || data[1] != 'S' || data[2] != 'A' || data[3] != 'N' || data[4] != VERSION) {
+    return false;
+  }
+  header->bytesPerLed = data[5];
+  header->fps = data[6] | data[7] << 8;
+  header->numLeds = readUint32(&data[8]);
+  header->numFrames = readUint32(&data[12]);
+  return (header->bytesPerLed == 3 || header->bytesPerLed == 4) && header->fps > 0;
+}
+
+inline void writeHeader(uint8_t* data, const Header& header) {
+  data[0] = 'W';
+  data[1] = 'S';
+  data[2] = 'A';
+  data[3] = 'N';
+  data[4] = VERSION;
+  data[5] = header.bytesPerLed;
+  data[6] = header.fps;
+  data[7] = header.fps >> 8;
+  writeUint32(&data[8], header.numLeds);
+  writeUint32(&data[12], header.numFrames);
+}
+
+}  // namespace AnimationFormat
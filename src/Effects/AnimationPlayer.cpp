@@ -0,0 +1,161 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <string.h>  // memmove
+
+#include "AnimationPlayer.h"
+
+AnimationPlayer::AnimationPlayer(AnimationSource* source, bool loop, size_t bufferSize) :
+  _source(source),
+  _loop(loop),
+  _buffer(nullptr),
+  _bufferSize(bufferSize < 64 ? 64 : bufferSize),
+  _bufferStart(0),
+  _bufferEnd(0),
+  _header(),
+  _playing(false),
+  _nextFrame(0),
+  _loopStart(0) {
+    _buffer = new uint8_t[_bufferSize];
+  }
+
+AnimationPlayer::~AnimationPlayer() {
+  delete[] _buffer;
+}
+
+void AnimationPlayer::setup(LedFrame& frame) {
+  _loopStart = 0;
+  _playing = _restart();
+  if (!_playing) {
+    log_e("not a valid animation");
+    return;
+  }
+  if (_header.numLeds != frame.size()) {
+    log_w("animation is made for %u leds, string has %u", static_cast<unsigned>(_header.numLeds),
+          static_cast<unsigned>(frame.size()));
+  }
+}
+
+void AnimationPlayer::render(LedFrame& frame, uint32_t timestamp) {
+  // catch up when frames are due, deltas can't be skipped
+  while (_playing && _nextFrame <= static_cast<uint64_t>(timestamp - _loopStart) * _header.fps / 1000) {
+    if (_nextFrame == _header.numFrames) {
+      if (!_loop) {
+        _playing = false;  // the last frame stays on
+        return;
+      }
+      _loopStart += static_cast<uint64_t>(_header.numFrames) * 1000 / _header.fps;
+      if (!_restart()) {
+        log_e("could not restart animation");
+        _playing = false;
+      }
+      continue;
+    }
+    if (!_decodeFrame(frame)) {
+      log_e("animation frame %u is corrupt", static_cast<unsigned>(_nextFrame));
+      _playing = false;
+      return;
+    }
+    ++_nextFrame;
+  }
+}
+
+bool AnimationPlayer::playing() const {
+  return _playing;
+}
+
+bool AnimationPlayer::_restart() {
+  _bufferStart = 0;
+  _bufferEnd = 0;
+  _nextFrame = 0;
+  if (!_source || !_source->seek(0) || !_fill(AnimationFormat::HEADER_SIZE)) return false;
+  if (!AnimationFormat::readHeader(&_buffer[_bufferStart], &_header) || _header.numFrames == 0) return false;
+  _bufferStart += AnimationFormat::HEADER_SIZE;
+  return true;
+}
+
+bool AnimationPlayer::_fill(size_t size) {
+  if (_bufferEnd - _bufferStart >= size) return true;
+  // keep the unread bytes and read as much as fits
+  memmove(_buffer, &_buffer[_bufferStart], _bufferEnd - _bufferStart);
+  _bufferEnd -= _bufferStart;
+  _bufferStart = 0;
+  _bufferEnd += _source->read(&_buffer[_bufferEnd], _bufferSize - _bufferEnd);
+  return _bufferEnd >= size;
+}
+
+bool AnimationPlayer::_decodeFrame(LedFrame& frame) {
+  if (!_fill(AnimationFormat::FRAME_HEADER_SIZE)) return false;
+  uint8_t type = _buffer[_bufferStart];
+  size_t first = AnimationFormat::readUint32(&_buffer[_bufferStart + 1]);
+  size_t end = AnimationFormat::readUint32(&_buffer[_bufferStart + 5]);
+  _bufferStart += AnimationFormat::FRAME_HEADER_SIZE;
+  if (type > AnimationFormat::DELTA || first > end || end > _header.numLeds) return false;
+
+  // leds beyond the end of the string are read but not written
+  size_t numLeds = frame.size();
+  Colour* leds = frame.pixels(first, end);
+  size_t bytesPerLed = _header.bytesPerLed;
+  size_t led = first;
+  while (led < end) {
+    if (!_fill(1)) return false;
+    uint8_t run = _buffer[_bufferStart++];
+    size_t count = (run & ~AnimationFormat::RUN_TYPE_MASK) + 1;
+    if (count > end - led) return false;
+    switch (run & AnimationFormat::RUN_TYPE_MASK) {
+      case AnimationFormat::SKIP:
+        led += count;
+        break;
+      case AnimationFormat::REPEAT: {
+        if (!_fill(bytesPerLed)) return false;
+        Colour colour = _colour(&_buffer[_bufferStart]);
+        _bufferStart += bytesPerLed;
+        for (; count > 0; --count, ++led) {
+          if (led < numLeds) leds[led] = colour;
+        }
+        break;
+      }
+      case AnimationFormat::LITERAL:
+        while (count > 0) {
+          if (!_fill(bytesPerLed)) return false;
+          // decode all the leds that are in the buffer at once
+          size_t available = (_bufferEnd - _bufferStart) / bytesPerLed;
+          if (available > count) available = count;
+          for (size_t i = 0; i < available; ++i, ++led) {
+            if (led < numLeds) leds[led] = _colour(&_buffer[_bufferStart]);
+            _bufferStart += bytesPerLed;
+          }
+          count -= available;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+Colour AnimationPlayer::_colour(const uint8_t* data) const {
+  return Colour(data[0], data[1], data[2], _header.bytesPerLed == 4 ? data[3] : 0);
+}
@@ -0,0 +1,83 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file AnimationPlayer.h
+ * @brief Effect that plays pre-rendered animations
+ */
+
+#pragma once
+
+#include "Effect.h"
+#include "Colour.h"
+#include "AnimationFormat.h"
+#include "AnimationSource.h"
+
+/**
+ * @brief Plays an animation in the format of AnimationFormat.h.
+ * 
+ * Frames are decoded straight into the led buffer through a small read-ahead buffer that is
+ * allocated once. Only the leds a frame changes are marked as changed, and nothing is done when no
+ * new frame is due. The animation keeps its own frame rate, independent of the frame rate of
+ * the string.
+ */
+class AnimationPlayer : public WS2811Effect {
+ public:
+  /**
+   * @brief Create a player.
+   * 
+   * @param source animation to play, not deleted by the player
+   * @param loop restart at the end, otherwise the last frame stays on
+   * @param bufferSize size of the read-ahead buffer in bytes, at least 64
+   */
+  explicit AnimationPlayer(AnimationSource* source, bool loop = true, size_t bufferSize = 512);
+  ~AnimationPlayer();
+  AnimationPlayer(const AnimationPlayer&) = delete;
+  AnimationPlayer& operator=(const AnimationPlayer&) = delete;
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
+
+  /**
+   * @brief Returns true while the animation is playing.
+   * 
+   * False when the animation is invalid or, when not looping, has ended.
+   */
+  bool playing() const;
+
+ private:
+  bool _restart();
+  bool _fill(size_t size);
+  bool _decodeFrame(LedFrame& frame);
+  Colour _colour(const uint8_t* data) const;
+  AnimationSource* _source;
+  bool _loop;
+  uint8_t* _buffer;
+  size_t _bufferSize;
+  size_t _bufferStart;  // unread bytes are [start, end)
+  size_t _bufferEnd;
+  AnimationFormat::Header _header;
+  bool _playing;
+  uint32_t _nextFrame;
+  uint32_t _loopStart;  // timestamp of the first frame of the current loop
+};
@@ -0,0 +1,57 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <string.h>  // memcpy
+
+#include "AnimationSource.h"
+
+MemoryAnimationSource::MemoryAnimationSource(const uint8_t* data, size_t size) :
+  _data(data),
+  _size(size),
+  _position(0) {}
+
+size_t MemoryAnimationSource::read(uint8_t* buffer, size_t size) {
+  if (size > _size - _position) size = _size - _position;
+  memcpy(buffer, &_data[_position], size);
+  _position += size;
+  return size;
+}
+
+bool MemoryAnimationSource::seek(size_t position) {
+  if (position > _size) return false;
+  _position = position;
+  return true;
+}
+
+FileAnimationSource::FileAnimationSource(FILE* file) :
+  _file(file) {}
+
+size_t FileAnimationSource::read(uint8_t* buffer, size_t size) {
+  if (!_file) return 0;
+  return fread(buffer, 1, size, _file);
+}
+
+bool FileAnimationSource::seek(size_t position) {
+  return _file && fseek(_file, position, SEEK_SET) == 0;
+}
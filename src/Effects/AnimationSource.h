@@ -0,0 +1,91 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file AnimationSource.h
+ * @brief Sources to read pre-rendered animations from
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>  // FILE
+
+/**
+ * @brief Sequential access to an animation, with seeking to restart it.
+ */
+class AnimationSource {
+ public:
+  virtual ~AnimationSource() {}
+
+  /**
+   * @brief Read the next bytes.
+   * 
+   * @return number of bytes read, less than size at the end of the animation
+   */
+  virtual size_t read(uint8_t* buffer, size_t size) = 0;
+
+  /**
+   * @brief Continue reading at the given position.
+   * 
+   * @return false when the position can't be reached
+   */
+  virtual bool seek(size_t position) = 0;
+};
+
+/**
+ * @brief Animation in memory, eg. a flash partition mapped with `esp_partition_mmap()` or a const array.
+ */
+class MemoryAnimationSource : public AnimationSource {
+ public:
+  /**
+   * @param data start of the animation, not copied
+   * @param size size of the animation in bytes
+   */
+  MemoryAnimationSource(const uint8_t* data, size_t size);
+  size_t read(uint8_t* buffer, size_t size) override;
+  bool seek(size_t position) override;
+
+ private:
+  const uint8_t* _data;
+  size_t _size;
+  size_t _position;
+};
+
+/**
+ * @brief Animation in a file, eg. on SPIFFS, LittleFS or an SD card mounted in the VFS.
+ */
+class FileAnimationSource : public AnimationSource {
+ public:
+  /**
+   * @param file file opened for reading, not closed by the source
+   */
+  explicit FileAnimationSource(FILE* file);
+  size_t read(uint8_t* buffer, size_t size) override;
+  bool seek(size_t position) override;
+
+ private:
+  FILE* _file;
+};
@@ -24,6 +24,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <math.h>  // ceilf, floorf, fabsf
+
 #include "Aurora.h"
 
 // List of colors allowed for waves
@@ -47,12 +49,12 @@ uint8_t colorweighting[3][5] = {
 
 // Function to get the color for a wave based on the weighting.
 // Paramter weighting: First index of colorweighting array. Basically what preset to choose.
-uint8_t getWeightedColor(uint8_t weighting) {
+uint8_t getWeightedColor(uint8_t weighting, EffectRandom& random) {
   uint8_t sumOfWeights = 0;
   for (uint8_t i = 0; i < sizeof(colorweighting[0]); ++i) {
     sumOfWeights += colorweighting[weighting][i];
   }
-  uint8_t randomweight = random(0, sumOfWeights);
+  uint8_t randomweight = random.below(sumOfWeights);
   for(uint8_t i = 0; i < sizeof(colorweighting[0]); ++i) {
     if (randomweight < colorweighting[weighting][i]) {
       return i;
@@ -62,55 +64,71 @@ uint8_t getWeightedColor(uint8_t weighting) {
   return 0;  // avoid compiler warning
 }
 
-Aurora::BorealisWave::BorealisWave(size_t numLeds) :
-  _numLeds(numLeds),
-  _ttl(random(500, 1501)),
-  _basecolor(getWeightedColor(W_COLOR_WEIGHT_PRESET)),
-  _basealpha(random(50, 100) / 100.0),
+Aurora::BorealisWave::BorealisWave() :
+  _numLeds(0),
+  _ttl(0),
+  _basecolor(0),
+  _basealpha(0),
   _age(0),
-  _width(random(_numLeds / 10, _numLeds / W_WIDTH_FACTOR)),
-  _center(random(100) / 100.0 * _numLeds),
-  _goingleft(rand() > (RAND_MAX / 2)),
-  _speed(random(10, 30) / 100.0 * W_SPEED_FACTOR),
-  _alive(true) {}
-
-Colour* Aurora::BorealisWave::getColorForLED(int ledIndex) {
-  if(ledIndex < _center - _width / 2 || ledIndex > _center + _width / 2) {
-    //Position out of range of this wave
-    return nullptr;
-  } else {
-    Colour* rgb = new Colour;
+  _width(0),
+  _center(0),
+  _goingleft(false),
+  _speed(0),
+  _alive(false) {}
+
+void Aurora::BorealisWave::spawn(size_t numLeds, EffectRandom& random) {
+  _numLeds = numLeds;
+  _ttl = random.between(500, 1501);
+  _basecolor = getWeightedColor(W_COLOR_WEIGHT_PRESET, random);
+  _basealpha = random.between(50, 100) / 100.0;
+  _age = 0;
+  _width = random.between(_numLeds / 10, _numLeds / W_WIDTH_FACTOR);
+  _center = random.below(100) / 100.0 * _numLeds;
+  _goingleft = random.below(2);
+  _speed = random.between(10, 30) / 100.0 * W_SPEED_FACTOR;
+  _alive = true;
+}
 
-    //Offset of this led from center of wave
-    //The further away from the center, the dimmer the LED
-    int offset = abs(ledIndex - _center);
-    float offsetFactor = (float)offset / (_width / 2);
-
-    //The age of the wave determines it brightness.
-    //At half its maximum age it will be the brightest.
-    float ageFactor = 1;        
-    if((float)_age / _ttl < 0.5) {
-      ageFactor = (float)_age / (_ttl / 2);
-    } else {
-      ageFactor = (float)(_ttl - _age) / ((float)_ttl * 0.5);
-    }
+void Aurora::BorealisWave::render(Colour* leds) const {
+  int halfWidth = _width / 2;
+  if (halfWidth == 0) return;
 
-    //Calculate color based on above factors and basealpha value
-    rgb->red = allowedcolors[_basecolor][0] * (1 - offsetFactor) * ageFactor * _basealpha;
-    rgb->green = allowedcolors[_basecolor][1] * (1 - offsetFactor) * ageFactor * _basealpha;
-    rgb->blue = allowedcolors[_basecolor][2] * (1 - offsetFactor) * ageFactor * _basealpha;
-  
-    return rgb;
+  //The age of the wave determines it brightness.
+  //At half its maximum age it will be the brightest.
+  float ageFactor = 1;
+  if (_age / _ttl < 0.5) {
+    ageFactor = _age / (_ttl / 2);
+  } else {
+    ageFactor = (float)(_ttl - _age) / ((float)_ttl * 0.5);
+  }
+  float alpha = ageFactor * _basealpha * 255;
+  if (alpha < 0) alpha = 0;
+  if (alpha > 255) alpha = 255;
+  Colour colour = scaleColour(Colour(allowedcolors[_basecolor][0],
+                                     allowedcolors[_basecolor][1],
+                                     allowedcolors[_basecolor][2]),
+                              alpha);
+
+  //Only the leds within the wave are touched
+  int first = ceilf(_center - halfWidth);
+  int last = floorf(_center + halfWidth);
+  if (first < 0) first = 0;
+  if (last > static_cast<int>(_numLeds) - 1) last = _numLeds - 1;
+  float fade = 255.0f / halfWidth;
+  for (int i = first; i <= last; ++i) {
+    //The further away from the center, the dimmer the LED
+    float offset = fabsf(i - _center);
+    leds[i] = addColours(leds[i], scaleColour(colour, 255 - offset * fade));
   }
 }
 
-void Aurora::BorealisWave::update() {
+void Aurora::BorealisWave::update(float steps) {
   if (_goingleft) {
-    _center -= _speed;
+    _center -= _speed * steps;
   } else {
-    _center += _speed;
+    _center += _speed * steps;
   }
-  _age++;
+  _age += steps;
   if (_age > _ttl) {
     _alive = false;
   } else {
@@ -126,58 +144,47 @@ void Aurora::BorealisWave::update() {
   }
 }
 
-bool Aurora::BorealisWave::stillAlive() {
+bool Aurora::BorealisWave::stillAlive() const {
   return _alive;
 }
 
-Aurora::Aurora() :
-  _waves() {}
+Aurora::Aurora(size_t numWaves) :
+  _numWaves(numWaves),
+  _waves(nullptr),
+  _lastTimestamp(0) {
+    _waves = new BorealisWave[_numWaves];
+  }
 
 Aurora::~Aurora() {
-  stop();
-  _cleanup();
+  delete[] _waves;
 }
 
-void Aurora::_setup() {
-  _ledstrip->clearAll();
-  _ledstrip->show();
-  for (size_t i = 0; i < W_COUNT; ++i) {
-    _waves[i] = new BorealisWave(_ledstrip->numLeds());
+void Aurora::setup(LedFrame& frame) {
+  _lastTimestamp = 0;
+  for (size_t i = 0; i < _numWaves; ++i) {
+    _waves[i].spawn(frame.size(), _random);
   }
 }
 
-void Aurora::_loop() {
-  for (size_t i = 0; i < W_COUNT; ++i) {
+void Aurora::render(LedFrame& frame, uint32_t timestamp) {
+  // waves move one step every W_STEP_MS, whatever the frame rate
+  float steps = (timestamp - _lastTimestamp) / static_cast<float>(W_STEP_MS);
+  _lastTimestamp = timestamp;
+  size_t numLeds = frame.size();
+  Colour* pixels = frame.pixels();
+  for (size_t i = 0; i < numLeds; ++i) {
+    pixels[i] = Colour();
+  }
+  for (size_t i = 0; i < _numWaves; ++i) {
     // Update values of wave
-    _waves[i]->update();
+    _waves[i].update(steps);
 
-    if(!(_waves[i]->stillAlive())) {
-      // If a wave dies, remove it from memory and spawn a new one
-      delete _waves[i];
-      _waves[i] = new BorealisWave(_ledstrip->numLeds());
+    if (!_waves[i].stillAlive()) {
+      // If a wave dies, reuse it for a new one
+      _waves[i].spawn(numLeds, _random);
     }
-  }
 
-  //Loop through LEDs to determine color
-  for (size_t i = 0; i < _ledstrip->numLeds(); ++i) {
-    Colour mixedRgb = Colour(0,0,0);
-    // For each LED we must check each wave if it is "active" at this position.
-    // If there are multiple waves active on a LED we multiply their values.
-    for(size_t j = 0; j < W_COUNT; ++j) {
-      Colour* rgb = _waves[j]->getColorForLED(i);
-      if(rgb != nullptr) {       
-        mixedRgb += *rgb;
-      }
-      delete[] rgb;
-    }
-    _ledstrip->setPixel(i, mixedRgb);
+    // Overlapping waves add up
+    _waves[i].render(pixels);
   }
-  _ledstrip->show();
-  delay(20);
 }
-
-void Aurora::_cleanup() {
-  for (size_t i = 0; i < W_COUNT; ++i) {
-    delete _waves[i];
-  }
-} 
@@ -28,12 +28,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Effect.h"
 #include "Colour.h"
+#include "ColourMath.h"
 
 
 //WAVE CONFIG
-#define W_COUNT 6                 // Number of simultaneous waves
 #define W_SPEED_FACTOR 3          // Higher number, higher speed
 #define W_WIDTH_FACTOR 1          // Higher number, smaller waves
+#define W_STEP_MS 20              // Time in ms in which a wave moves by its speed
 #define W_COLOR_WEIGHT_PRESET 1   // What color weighting to choose
 #define W_RANDOM_SEED 11          // Change this seed for a different pattern. If you read from
                                   // an analog input here you can get a different pattern everytime.
@@ -41,17 +42,18 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 class Aurora : public WS2811Effect {
   class BorealisWave {
   public:
-    explicit BorealisWave(size_t numLeds);
-    Colour* getColorForLED(int ledIndex);
-    void update();
-    bool stillAlive();
+    BorealisWave();
+    void spawn(size_t numLeds, EffectRandom& random);
+    void render(Colour* leds) const;
+    void update(float steps);
+    bool stillAlive() const;
     
   private:
     size_t _numLeds;
     int _ttl;
     uint8_t _basecolor;
     float _basealpha;
-    int _age;
+    float _age;
     int _width;
     float _center;
     bool _goingleft;
@@ -60,12 +62,18 @@ class Aurora : public WS2811Effect {
   };
 
  public:
-  explicit Aurora();
+  /**
+   * @brief Create the aurora effect.
+   * 
+   * @param numWaves number of simultaneous waves, defaults to 6
+   */
+  explicit Aurora(size_t numWaves = 6);
   ~Aurora();
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
 
  private:
-  void _setup();
-  void _loop();
-  void _cleanup();
-  BorealisWave* _waves[W_COUNT];
+  size_t _numWaves;
+  BorealisWave* _waves;
+  uint32_t _lastTimestamp;
 };
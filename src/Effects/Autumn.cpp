@@ -45,65 +45,57 @@ const Colour Autumn::_colours[] = {
 const size_t Autumn::_numberColours = 6;
 
 Autumn::Autumn(uint32_t steps, uint32_t delay) :
-  _steps(steps),
-  _step(0),
+  _startLed(0),
+  _steps(steps ? steps : 1),  // divided by while rendering
   _delay(delay),
-  _lastMillis(0),
+  _transitionStart(0),
   _currentColourIndex(0),
-  _nextColourIndex(0) {}
+  _nextColourIndex(0),
+  _transitionDone(true) {}
 
-void Autumn::_setup() {
-  _currentColourIndex = random(_numberColours);
+void Autumn::setup(LedFrame& frame) {
+  _currentColourIndex = _random.below(_numberColours);
   _nextColourIndex = _currentColourIndex;
-  _ledstrip->setAll(_colours[_currentColourIndex]);
-  _ledstrip->show();
-  _lastMillis = millis();
+  Colour* pixels = frame.pixels();
+  for (size_t i = 0; i < frame.size(); ++i) {
+    pixels[i] = _colours[_currentColourIndex];
+  }
+  _transitionStart = 0;
+  _transitionDone = true;
 }
 
-void Autumn::_loop() {
-  uint32_t currentMillis = millis();
-  if (currentMillis - _lastMillis > _delay) {
-    _lastMillis = currentMillis;
-    _startLed = random(_ledstrip->numLeds() + 1);
-    _step = 0;
+void Autumn::render(LedFrame& frame, uint32_t timestamp) {
+  size_t numLeds = frame.size();
+  if (timestamp - _transitionStart > _delay) {
+    _transitionStart = timestamp;
+    _startLed = _random.below(numLeds + 1);
     _currentColourIndex = _nextColourIndex;
-    _nextColourIndex = random(_numberColours);
+    _nextColourIndex = _random.below(_numberColours);
+    _transitionDone = false;
   }
+  if (_transitionDone) return;  // leds keep their colour
 
-  size_t numLeds = _ledstrip->numLeds();
-  if (_step > 4 * _steps) {  // TODO(bertmelis): check for max instead of arbitrary 4x number of steps
-    delay(10);  // arbitrary delay to keep task idle
-    return;
+  // one step per ms, every led starts stepSize ms after its neighbour closer to the start led
+  uint32_t step = timestamp - _transitionStart;
+  uint32_t stepSize = numLeds > 1 ? _steps / (numLeds / 2) : 0;
+  size_t maxDist = _startLed < numLeds / 2 ? numLeds - 1 - _startLed : _startLed;
+  if (step >= _steps + stepSize * maxDist) {
+    step = _steps + stepSize * maxDist;  // render the last frame of the transition once
+    _transitionDone = true;
   }
 
-  // assure safe unsigned to signed int conversion
-  assert(numLeds <= INT_MAX);
-
-  //int32_t maxDist = std::max(std::abs((int32_t)_startLed - 0), std::abs((int32_t)_startLed - (int32_t)numLeds));
-	//int32_t stepSize = _steps / maxDist;
-  int32_t stepSize = _steps / (numLeds / 2);
-
+  Colour* pixels = frame.pixels();
   for (size_t i = 0; i < numLeds; ++i) {
-    // calculate distance to start
-    int32_t dist = std::abs((int32_t)_startLed - (int32_t)i);
-		int32_t ledStep = _step - stepSize * dist;
-		if (ledStep < 0) ledStep = 0;
-		if (ledStep > _steps) ledStep = _steps;
+    size_t dist = i > _startLed ? i - _startLed : _startLed - i;
+    uint32_t delay = stepSize * dist;
+    uint32_t ledStep = step > delay ? step - delay : 0;
+    if (ledStep > _steps) ledStep = _steps;
     /*
     ColourHSV c(_colours[_currentColourIndex].hue + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].hue - _colours[_currentColourIndex].hue),
                 _colours[_currentColourIndex].sat + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].sat - _colours[_currentColourIndex].sat),
                 _colours[_currentColourIndex].val + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].val - _colours[_currentColourIndex].val));
     */
-    Colour c(_colours[_currentColourIndex].red + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].red - _colours[_currentColourIndex].red),
-             _colours[_currentColourIndex].green + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].green - _colours[_currentColourIndex].green),
-             _colours[_currentColourIndex].blue + (ledStep * 1.0 / _steps) * (_colours[_nextColourIndex].blue - _colours[_currentColourIndex].blue));
-    _ledstrip->setPixel(i, c);
+    Colour c = lerpColours(_colours[_currentColourIndex], _colours[_nextColourIndex], ledStep * 255 / _steps);
+    pixels[i] = c;
   }
-  ++_step;
-  _ledstrip->show();
-  delay(1);
 }
-
-void Autumn::_cleanup() {
-  // nothing to clean up
-}
\ No newline at end of file
@@ -26,15 +26,19 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Effect.h"
 #include "Colour.h"
+#include "ColourMath.h"
 
 class Autumn : public WS2811Effect {
  public:
+  /**
+   * @brief Create the autumn effect.
+   * 
+   * @param steps duration of a colour transition in ms, at least 1
+   * @param delay time between the start of two transitions in ms
+   */
   explicit Autumn(uint32_t steps, uint32_t delay);
-
- private:
-  void _setup();
-  void _loop();
-  void _cleanup();
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
 
  private:
   // static const ColourHSV _colours[];
@@ -42,9 +46,9 @@ class Autumn : public WS2811Effect {
   static const size_t _numberColours;
   size_t _startLed;
   uint32_t _steps;
-  uint32_t _step;
   uint32_t _delay;
-  uint32_t _lastMillis;
+  uint32_t _transitionStart;
   uint8_t _currentColourIndex;
   uint8_t _nextColourIndex;
+  bool _transitionDone;
 };
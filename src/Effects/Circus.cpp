@@ -25,22 +25,23 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Circus.h"
 
 Circus::Circus(uint32_t interval) :
-  _interval(interval) {}
+  _interval(interval),
+  _lastChange(0) {}
 
-void Circus::_setup() {
-  _ledstrip->clearAll();
-  _ledstrip->show();
+void Circus::setup(LedFrame& frame) {
+  _lastChange = 0;
+  _shuffle(frame);
 }
 
-void Circus::_loop() {
-  size_t numLeds = _ledstrip->numLeds();
-  for (size_t i = 0; i < numLeds; ++i) {
-    _ledstrip->setPixel(i, Colour::colours[random(0, 12)]);
-  }
-  _ledstrip->show();
-  delay(_interval);
+void Circus::render(LedFrame& frame, uint32_t timestamp) {
+  if (timestamp - _lastChange < _interval) return;  // nothing changes, leds keep their colour
+  _lastChange = timestamp;
+  _shuffle(frame);
 }
 
-void Circus::_cleanup() {
-  // nothing to clean up
-}
\ No newline at end of file
+void Circus::_shuffle(LedFrame& frame) {
+  Colour* pixels = frame.pixels();
+  for (size_t i = 0; i < frame.size(); ++i) {
+    pixels[i] = Colour::colours[_random.below(12)];
+  }
+}
@@ -30,12 +30,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 class Circus : public WS2811Effect {
  public:
   explicit Circus(uint32_t interval);
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
 
  private:
-  void _setup();
-  void _loop();
-  void _cleanup();
-
- private:
+  void _shuffle(LedFrame& frame);
   uint32_t _interval;
+  uint32_t _lastChange;
 };
@@ -23,6 +23,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include "Colour.h"
+#include "ColourMath.h"
 
 const Colour Colour::colours[] {
   {0xFF, 0x00, 0x00},  /// red
@@ -42,23 +43,23 @@ const Colour Colour::colours[] {
 Colour::Colour() :
   red(0),
   green(0),
-  blue(0) {}
+  blue(0),
+  white(0) {}
 
 Colour::Colour(uint8_t r, uint8_t g, uint8_t b) :
   red(r),
   green(g),
-  blue(b) {}
+  blue(b),
+  white(0) {}
+
+Colour::Colour(uint8_t r, uint8_t g, uint8_t b, uint8_t w) :
+  red(r),
+  green(g),
+  blue(b),
+  white(w) {}
 
 Colour& Colour::operator+=(const Colour& rhs) {
-  uint16_t r = red + rhs.red;
-  if (r > 255)  r = 255;
-  red = r;
-  uint16_t g = green + rhs.green;
-  if (g > 255)  g = 255;
-  green = g;
-  uint16_t b = blue + rhs.blue;
-  if (b > 255)  b = 255;
-  blue = b;
+  *this = addColours(*this, rhs);
   return *this;
 }
 
@@ -116,4 +117,16 @@ ColourHSV::operator Colour() const {
     b = X;
   }
   return Colour((r + m) * 255, (g + m) * 255, (b + m) * 255);
-}
\ No newline at end of file
+}
+
+void hsvToRgb(const ColourHSV8* hsv, Colour* rgb, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    rgb[i] = hsv[i];
+  }
+}
+
+void hsvToRgb(const ColourHSV* hsv, Colour* rgb, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    rgb[i] = hsv[i];
+  }
+}
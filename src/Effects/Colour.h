@@ -29,19 +29,23 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <cmath>  // abs, fmod
 
 /**
- * @brief Class to hold RGB values. 
+ * @brief Class to hold RGB(W) values. 
+ * 
+ * The white component is only sent to leds with a white channel, eg. SK6812 RGBW.
+ * Colours are aligned to 32 bits so they can be processed as a single word, see ColourMath.h.
  */
-class Colour {
+class alignas(4) Colour {
  public:
   /**
    * @brief Create a colour.
    * 
    * When no arguments are given to instantiate the class, the colour 
-   * will be set to black (zero value for red, green and blue)
+   * will be set to black (zero value for red, green, blue and white)
    */
   Colour();
 
@@ -54,9 +58,34 @@ class Colour {
    */
   Colour(uint8_t r, uint8_t g, uint8_t b);
 
+  /**
+   * @brief Create a colour with the given values, including white.
+   * 
+   * @param r red value, 0-255
+   * @param g green value, 0-255
+   * @param b blue value, 0-255
+   * @param w white value, 0-255
+   */
+  Colour(uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+
   uint8_t red;    ///< red value, 0-255
   uint8_t green;  ///< green value, 0-255
   uint8_t blue;   ///< blue value, 0-255
+  uint8_t white;  ///< white value, 0-255
+
+  /**
+   * @brief Move the white part of the colour to the white channel.
+   * 
+   * The common part of red, green and blue is moved to the white channel, for RGBW leds.
+   * 
+   * @return the RGBW colour
+   */
+  Colour toRGBW() const {
+    uint8_t w = red < green ? red : green;
+    if (blue < w) w = blue;
+    uint16_t newWhite = white + w;
+    return Colour(red - w, green - w, blue - w, newWhite > 255 ? 255 : newWhite);
+  }
 
   /**
    * @brief Adds a colour to this colour.
@@ -102,3 +131,84 @@ class ColourHSV {
  float sat;   ///< saturation, 0-1 (converted from percentage to absolute value)
  float val;   ///< value, 0-1 (converted from percentage to absolute value)
 };
+
+/**
+ * @brief Class to hold 8 bit HSV values with fast integer conversion to RGB
+ * 
+ * Unlike `ColourHSV`, all components use the full 0-255 range and the conversion doesn't use
+ * floating point math or branches. Every colour component of the result is within 1 of the
+ * exact (rounded) conversion.
+ */
+class ColourHSV8 {
+ public:
+  /**
+   * @brief Create a colour.
+   * 
+   * When no arguments are given to instantiate the class, the colour 
+   * will be set to black (zero value for hue, saturation and value)
+   */
+  ColourHSV8() :
+    hue(0),
+    sat(0),
+    val(0) {}
+
+  /**
+   * @brief Create a colour with the given values.
+   * 
+   * @param h hue, 0-255 covers the full colour wheel: 0 is red, 85 is green and 170 is blue
+   * @param s saturation, 0-255
+   * @param v value, 0-255
+   */
+  ColourHSV8(uint8_t h, uint8_t s, uint8_t v) :
+    hue(h),
+    sat(s),
+    val(v) {}
+
+  /**
+   * @brief Implicit conversion from ColourHSV8 to RGB Colour
+   */
+  operator Colour() const {
+    // which of the levels every component takes in each of the six sectors of the colour wheel
+    static const uint8_t selectors[6][3] = {
+      {3, 1, 0},  // red to yellow: red at max, green rising
+      {2, 3, 0},  // yellow to green
+      {0, 3, 1},  // green to cyan
+      {0, 2, 3},  // cyan to blue
+      {1, 0, 3},  // blue to magenta
+      {3, 0, 2}   // magenta to red
+    };
+    uint16_t position = hue * 6;
+    uint8_t sector = position >> 8;
+    uint8_t fraction = position;
+    uint16_t vs = val * sat + 128;
+    uint8_t chroma = (vs + (vs >> 8)) >> 8;  // val * sat / 255, rounded
+    uint8_t rising = (chroma * fraction + 128) >> 8;
+    uint8_t min = val - chroma;
+    const uint8_t levels[4] = {min, static_cast<uint8_t>(min + rising),
+                               static_cast<uint8_t>(val - rising), val};
+    const uint8_t* selector = selectors[sector];
+    return Colour(levels[selector[0]], levels[selector[1]], levels[selector[2]]);
+  }
+
+  uint8_t hue;  ///< hue, 0-255
+  uint8_t sat;  ///< saturation, 0-255
+  uint8_t val;  ///< value, 0-255
+};
+
+/**
+ * @brief Convert a number of HSV colours to RGB.
+ * 
+ * @param hsv colours to convert
+ * @param rgb destination, has to hold count colours
+ * @param count number of colours to convert
+ */
+void hsvToRgb(const ColourHSV8* hsv, Colour* rgb, size_t count);
+
+/**
+ * @brief Convert a number of floating point HSV colours to RGB.
+ * 
+ * @param hsv colours to convert
+ * @param rgb destination, has to hold count colours
+ * @param count number of colours to convert
+ */
+void hsvToRgb(const ColourHSV* hsv, Colour* rgb, size_t count);
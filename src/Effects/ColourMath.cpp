@@ -0,0 +1,61 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "ColourMath.h"
+
+void addBuffers(Colour* leds, const Colour* add, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = addColours(leds[i], add[i]);
+  }
+}
+
+void scaleBuffer(Colour* leds, size_t count, uint8_t scale) {
+  uint16_t weight = scale + 1;
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = ColourMath::unpack(ColourMath::scale(ColourMath::pack(leds[i]), weight));
+  }
+}
+
+void lerpBuffers(Colour* leds, const Colour* from, const Colour* to, size_t count, uint8_t amount) {
+  uint16_t weight = ColourMath::weight(amount);
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = ColourMath::unpack(ColourMath::lerp(ColourMath::pack(from[i]), ColourMath::pack(to[i]), weight));
+  }
+}
+
+void fadeBuffer(Colour* leds, size_t count, uint8_t amount) {
+  scaleBuffer(leds, count, 255 - amount);
+}
+
+void maxBuffers(Colour* leds, const Colour* other, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = maxColours(leds[i], other[i]);
+  }
+}
+
+void multiplyBuffers(Colour* leds, const Colour* other, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = multiplyColours(leds[i], other[i]);
+  }
+}
@@ -0,0 +1,199 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file ColourMath.h
+ * @brief Saturating add, scale, lerp and fade of colours, for single colours and whole buffers
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>  // memcpy
+
+#include "Colour.h"
+
+static_assert(sizeof(Colour) == 4 && alignof(Colour) == 4, "Colour has to pack into a 32 bit word");
+
+/*
+ * The colour components are processed as one packed 32 bit word (SWAR). Multiplications work on
+ * two components at a time so the 16 bit products stay in their own half of the word.
+ */
+
+namespace ColourMath {
+
+inline uint32_t pack(Colour colour) {
+  uint32_t packed;
+  memcpy(&packed, &colour, sizeof(packed));
+  return packed;
+}
+
+inline Colour unpack(uint32_t packed) {
+  Colour colour;
+  memcpy(static_cast<void*>(&colour), &packed, sizeof(colour));
+  return colour;
+}
+
+inline uint32_t add(uint32_t a, uint32_t b) {
+  uint32_t sum = (a & 0x7F7F7F7F) + (b & 0x7F7F7F7F);  // no carry into the next component
+  uint32_t high = (a ^ b) & 0x80808080;
+  uint32_t overflow = ((a & b) | (high & sum)) & 0x80808080;
+  return (sum ^ high) | ((overflow >> 7) * 0xFF);
+}
+
+inline uint32_t scale(uint32_t packed, uint16_t weight) {  // weight 0-256
+  uint32_t even = ((packed & 0x00FF00FF) * weight >> 8) & 0x00FF00FF;
+  uint32_t odd = ((packed >> 8) & 0x00FF00FF) * weight & 0xFF00FF00;
+  return even | odd;
+}
+
+inline uint32_t lerp(uint32_t a, uint32_t b, uint16_t weight) {  // weight 0-256
+  uint32_t even = ((a & 0x00FF00FF) * (256 - weight) + (b & 0x00FF00FF) * weight) >> 8 & 0x00FF00FF;
+  uint32_t odd = (((a >> 8) & 0x00FF00FF) * (256 - weight) + ((b >> 8) & 0x00FF00FF) * weight) & 0xFF00FF00;
+  return even | odd;
+}
+
+inline uint32_t max(uint32_t a, uint32_t b) {
+  // a bit above every 16 bit lane survives the subtraction when a >= b and selects a
+  uint32_t even = ((a & 0x00FF00FF) | 0x01000100) - (b & 0x00FF00FF);
+  uint32_t odd = (((a >> 8) & 0x00FF00FF) | 0x01000100) - ((b >> 8) & 0x00FF00FF);
+  uint32_t mask = (((even >> 8) & 0x00010001) | ((odd & 0x01000100))) * 0xFF;
+  return (a & mask) | (b & ~mask);
+}
+
+inline uint32_t multiply(uint32_t a, uint32_t b) {
+  // every component needs its own product, 255 * 255 stays 255
+  uint32_t result = 0;
+  for (uint32_t shift = 0; shift < 32; shift += 8) {
+    result |= (((a >> shift) & 0xFF) * (((b >> shift) & 0xFF) + 1) >> 8) << shift;
+  }
+  return result;
+}
+
+inline uint16_t weight(uint8_t amount) {  // maps 0-255 to 0-256 so 255 is exact
+  return amount + (amount >> 7);
+}
+
+}  // namespace ColourMath
+
+/**
+ * @brief Add two colours, every component saturates at 255.
+ */
+inline Colour addColours(Colour a, Colour b) {
+  return ColourMath::unpack(ColourMath::add(ColourMath::pack(a), ColourMath::pack(b)));
+}
+
+/**
+ * @brief Scale a colour.
+ * 
+ * @param colour colour to scale
+ * @param scale 0-255, 255 leaves the colour unchanged
+ */
+inline Colour scaleColour(Colour colour, uint8_t scale) {
+  return ColourMath::unpack(ColourMath::scale(ColourMath::pack(colour), scale + 1));
+}
+
+/**
+ * @brief Blend from one colour to another.
+ * 
+ * @param from colour at amount 0
+ * @param to colour at amount 255
+ * @param amount 0-255
+ */
+inline Colour lerpColours(Colour from, Colour to, uint8_t amount) {
+  return ColourMath::unpack(ColourMath::lerp(ColourMath::pack(from), ColourMath::pack(to), ColourMath::weight(amount)));
+}
+
+/**
+ * @brief Returns the maximum of two colours, per component.
+ */
+inline Colour maxColours(Colour a, Colour b) {
+  return ColourMath::unpack(ColourMath::max(ColourMath::pack(a), ColourMath::pack(b)));
+}
+
+/**
+ * @brief Multiply two colours, per component. White (255) leaves the other colour unchanged.
+ */
+inline Colour multiplyColours(Colour a, Colour b) {
+  return ColourMath::unpack(ColourMath::multiply(ColourMath::pack(a), ColourMath::pack(b)));
+}
+
+/**
+ * @brief Add a buffer of colours to another, every component saturates at 255.
+ * 
+ * @param leds colours to add to
+ * @param add colours to add
+ * @param count number of colours
+ */
+void addBuffers(Colour* leds, const Colour* add, size_t count);
+
+/**
+ * @brief Scale a buffer of colours.
+ * 
+ * @param leds colours to scale
+ * @param count number of colours
+ * @param scale 0-255, 255 leaves the colours unchanged
+ */
+void scaleBuffer(Colour* leds, size_t count, uint8_t scale);
+
+/**
+ * @brief Blend two buffers of colours.
+ * 
+ * `leds` may be the same buffer as `from` or `to`.
+ * 
+ * @param leds destination
+ * @param from colours at amount 0
+ * @param to colours at amount 255
+ * @param count number of colours
+ * @param amount 0-255
+ */
+void lerpBuffers(Colour* leds, const Colour* from, const Colour* to, size_t count, uint8_t amount);
+
+/**
+ * @brief Fade a buffer of colours to black.
+ * 
+ * @param leds colours to fade
+ * @param count number of colours
+ * @param amount 0-255, 255 turns the leds off
+ */
+void fadeBuffer(Colour* leds, size_t count, uint8_t amount);
+
+/**
+ * @brief Keep the maximum of two buffers of colours, per component.
+ * 
+ * @param leds colours to compare, receives the result
+ * @param other colours to compare with
+ * @param count number of colours
+ */
+void maxBuffers(Colour* leds, const Colour* other, size_t count);
+
+/**
+ * @brief Multiply a buffer of colours with another, per component.
+ * 
+ * @param leds colours to multiply, receives the result
+ * @param other colours to multiply with
+ * @param count number of colours
+ */
+void multiplyBuffers(Colour* leds, const Colour* other, size_t count);
@@ -0,0 +1,153 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "Compositor.h"
+
+Compositor::Compositor(size_t numLeds, size_t maxLayers) :
+  _numLeds(numLeds),
+  _maxLayers(maxLayers),
+  _numLayers(0),
+  _layers(nullptr),
+  _buffers(nullptr) {
+    _layers = new Layer[_maxLayers];
+    _buffers = new Colour[_numLeds * _maxLayers];
+  }
+
+Compositor::~Compositor() {
+  delete[] _layers;
+  delete[] _buffers;
+}
+
+bool Compositor::addLayer(WS2811Effect* effect, Blend blend, uint8_t opacity) {
+  if (!effect) {
+    log_w("Empty effect ptr: layer not added");
+    return false;
+  }
+  if (_numLayers == _maxLayers) {
+    log_w("no layer available");
+    return false;
+  }
+  _layers[_numLayers].effect = effect;
+  _layers[_numLayers].blend = blend;
+  _layers[_numLayers].opacity = opacity;
+  ++_numLayers;
+  return true;
+}
+
+void Compositor::setOpacity(size_t layer, uint8_t opacity) {
+  if (layer < _numLayers) {
+    _layers[layer].opacity = opacity;
+  }
+}
+
+size_t Compositor::numLayers() const {
+  return _numLayers;
+}
+
+void Compositor::setup(LedFrame& frame) {
+  if (frame.size() != _numLeds) {
+    log_w("compositor is made for %u leds, string has %u", static_cast<unsigned>(_numLeds),
+          static_cast<unsigned>(frame.size()));
+  }
+  size_t numLeds = frame.size() < _numLeds ? frame.size() : _numLeds;
+  for (size_t i = 0; i < _numLayers; ++i) {
+    Colour* buffer = &_buffers[i * _numLeds];
+    for (size_t j = 0; j < numLeds; ++j) {
+      buffer[j] = Colour();
+    }
+    LedFrame layer(buffer, numLeds);
+    _layers[i].effect->setup(layer);
+  }
+}
+
+void Compositor::render(LedFrame& frame, uint32_t timestamp) {
+  size_t numLeds = frame.size() < _numLeds ? frame.size() : _numLeds;
+  // layers keep their previous frame so effects only have to update what changes
+  for (size_t i = 0; i < _numLayers; ++i) {
+    LedFrame layer(&_buffers[i * _numLeds], numLeds);
+    _layers[i].effect->render(layer, timestamp);
+  }
+  Colour* pixels = frame.pixels();
+  for (size_t i = 0; i < numLeds; ++i) {
+    pixels[i] = Colour();
+  }
+  for (size_t i = 0; i < _numLayers; ++i) {
+    _blend(pixels, &_buffers[i * _numLeds], numLeds, _layers[i].blend, _layers[i].opacity);
+  }
+}
+
+void Compositor::cleanup() {
+  for (size_t i = 0; i < _numLayers; ++i) {
+    _layers[i].effect->cleanup();
+  }
+}
+
+void Compositor::seed(uint32_t seed) {
+  WS2811Effect::seed(seed);
+  for (size_t i = 0; i < _numLayers; ++i) {
+    _layers[i].effect->seed(seed + i + 1);
+  }
+}
+
+void Compositor::_blend(Colour* leds, const Colour* layer, size_t count, Blend blend, uint8_t opacity) {
+  // the blend mode and opacity are resolved once per layer, the loops only process packed colours
+  uint16_t weight = ColourMath::weight(opacity);
+  switch (blend) {
+    case Blend::ADD:
+      if (opacity == 255) {
+        addBuffers(leds, layer, count);
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          uint32_t scaled = ColourMath::scale(ColourMath::pack(layer[i]), weight);
+          leds[i] = ColourMath::unpack(ColourMath::add(ColourMath::pack(leds[i]), scaled));
+        }
+      }
+      break;
+    case Blend::ALPHA:
+      lerpBuffers(leds, leds, layer, count, opacity);
+      break;
+    case Blend::MULTIPLY:
+      if (opacity == 255) {
+        multiplyBuffers(leds, layer, count);
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          uint32_t below = ColourMath::pack(leds[i]);
+          uint32_t blended = ColourMath::multiply(below, ColourMath::pack(layer[i]));
+          leds[i] = ColourMath::unpack(ColourMath::lerp(below, blended, weight));
+        }
+      }
+      break;
+    case Blend::MAX:
+      if (opacity == 255) {
+        maxBuffers(leds, layer, count);
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          uint32_t below = ColourMath::pack(leds[i]);
+          uint32_t blended = ColourMath::max(below, ColourMath::pack(layer[i]));
+          leds[i] = ColourMath::unpack(ColourMath::lerp(below, blended, weight));
+        }
+      }
+      break;
+  }
+}
@@ -0,0 +1,109 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file Compositor.h
+ * @brief Effect that blends the output of several effects
+ */
+
+#pragma once
+
+#include "Effect.h"
+#include "Colour.h"
+#include "ColourMath.h"
+
+/**
+ * @brief Renders several effects into their own layer and blends the layers into the frame.
+ * 
+ * The layer buffers are allocated once on construction. Layers are blended bottom to top,
+ * the first layer is blended onto black.
+ */
+class Compositor : public WS2811Effect {
+ public:
+  /**
+   * @brief How a layer is combined with the layers below.
+   */
+  enum class Blend : uint8_t {
+    ADD,       ///< add, saturating
+    ALPHA,     ///< cross-fade by the opacity of the layer
+    MULTIPLY,  ///< multiply, eg. as a mask
+    MAX        ///< keep the brightest value per component
+  };
+
+  /**
+   * @brief Create a compositor.
+   * 
+   * @param numLeds number of leds of the string the compositor will run on
+   * @param maxLayers maximum number of layers, defaults to 4
+   */
+  explicit Compositor(size_t numLeds, size_t maxLayers = 4);
+  ~Compositor();
+  Compositor(const Compositor&) = delete;
+  Compositor& operator=(const Compositor&) = delete;
+
+  /**
+   * @brief Add a layer on top of the existing layers. Has to be called before the compositor is started.
+   * 
+   * @param effect effect that renders the layer
+   * @param blend how the layer is combined with the layers below, defaults to ADD
+   * @param opacity 0-255, defaults to 255
+   * @return false when all layers are in use
+   */
+  bool addLayer(WS2811Effect* effect, Blend blend = Blend::ADD, uint8_t opacity = 255);
+
+  /**
+   * @brief Change the opacity of a layer. Can be changed at any time.
+   * 
+   * @param layer index of the layer, in the order they were added
+   * @param opacity 0-255
+   */
+  void setOpacity(size_t layer, uint8_t opacity);
+
+  /**
+   * @brief Returns the number of layers.
+   */
+  size_t numLayers() const;
+
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
+  void cleanup() override;
+
+  /**
+   * @brief Seed the effects of all layers, every layer gets its own sequence.
+   */
+  void seed(uint32_t seed) override;
+
+ private:
+  struct Layer {
+    WS2811Effect* effect;
+    Blend blend;
+    volatile uint8_t opacity;
+  };
+  static void _blend(Colour* leds, const Colour* layer, size_t count, Blend blend, uint8_t opacity);
+  const size_t _numLeds;
+  const size_t _maxLayers;
+  size_t _numLayers;
+  Layer* _layers;
+  Colour* _buffers;  // _maxLayers buffers of _numLeds
+};
@@ -1,28 +1,18 @@
 #include "Effect.h"
 
 WS2811Effect::WS2811Effect() :
-  _task(nullptr),
-  _ledstrip(nullptr) {}
+  _random(random(0x7FFFFFFF)) {}
 
-WS2811Effect::~WS2811Effect() {
-  stop();
-}
+WS2811Effect::~WS2811Effect() {}
 
-void WS2811Effect::start(WS2811* ledstrip) {
-  _ledstrip = ledstrip;
-  xTaskCreate((TaskFunction_t)&_effectTask, "effectTask", 2048, this, 1, &_task);
+void WS2811Effect::setup(LedFrame& frame) {
+  (void)frame;  // nothing to set up by default
 }
 
-void WS2811Effect::stop() {
-  if (!_task) return;
-  vTaskDelete(_task);
-  _cleanup();
+void WS2811Effect::cleanup() {
+  // nothing to clean up by default
 }
 
-void WS2811Effect::_effectTask(WS2811Effect* e) {
-  e->_setup();
-  while(1) {
-    e->_loop();
-  }
-  vTaskDelete(nullptr);
+void WS2811Effect::seed(uint32_t seed) {
+  _random.seed(seed);
 }
@@ -43,33 +43,63 @@ extern "C" {
 #include <Arduino.h>  // delay, random...
 
 #include "../esp32WS2811.h"
-
-class WS2811;
+#include "EffectRandom.h"
 
 /**
  * @brief Pure virtual base class to built effects. 
  * 
- * Effects have to be (publicly) inherit from this class.
+ * Effects have to be (publicly) inherit from this class. The render engine of the string
+ * calls `render()` for every frame, from the render task and with the led buffer locked.
+ * Effects should not block or call `show()` themselves.
+ * 
+ * Effects only depend on the timestamp and on their own random numbers, not on the time of
+ * day or Arduino's `random()`. That way they can also be rendered faster than real time.
  */
 class WS2811Effect {
  public:
   WS2811Effect();
   virtual ~WS2811Effect();
-  void start(WS2811* ledstrip);
-  void stop();
 
- private:
-  virtual void _setup() = 0;
-  virtual void _loop() = 0;
-  virtual void _cleanup() = 0;
-  static void _effectTask(WS2811Effect* e);
+  /**
+   * @brief Called before the first frame of the effect is rendered.
+   * 
+   * @param frame the led buffer
+   */
+  virtual void setup(LedFrame& frame);
+
+  /**
+   * @brief Render a frame.
+   * 
+   * Only write the leds that change. Use `frame.setPixel()` for a few leds or `frame.pixels()`
+   * to write the whole buffer.
+   * 
+   * @param frame the led buffer, holding the previous frame
+   * @param timestamp time since the effect started in ms
+   */
+  virtual void render(LedFrame& frame, uint32_t timestamp) = 0;
+
+  /**
+   * @brief Called when the effect is stopped.
+   */
+  virtual void cleanup();
+
+  /**
+   * @brief Seed the random numbers of the effect.
+   * 
+   * A seeded effect renders the same frames for the same timestamps. Effects are seeded
+   * from Arduino's `random()` on construction.
+   * 
+   * @param seed any number
+   */
+  virtual void seed(uint32_t seed);
 
  protected:
-  TaskHandle_t _task;
-  WS2811* _ledstrip;
+  EffectRandom _random;
 };
 
 #include "Circus.h"
 #include "SnowSparkle.h"
 #include "Aurora.h"
 #include "Autumn.h"
+#include "Compositor.h"
+#include "AnimationPlayer.h"
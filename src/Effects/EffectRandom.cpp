@@ -0,0 +1,39 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "EffectRandom.h"
+
+EffectRandom::EffectRandom(uint32_t seed) :
+  _state(0) {
+  this->seed(seed);
+}
+
+void EffectRandom::seed(uint32_t seed) {
+  // mix the seed so nearby seeds give unrelated sequences, xorshift can't start from 0
+  uint32_t state = seed + 0x9E3779B9;
+  state = (state ^ (state >> 16)) * 0x85EBCA6B;
+  state = (state ^ (state >> 13)) * 0xC2B2AE35;
+  state ^= state >> 16;
+  _state = state ? state : 1;
+}
@@ -0,0 +1,79 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file EffectRandom.h
+ * @brief Seedable random numbers for effects
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Random number generator of an effect (xorshift32).
+ * 
+ * Unlike Arduino's `random()`, the numbers only depend on the seed so an effect can be rendered
+ * again with exactly the same output. It is also much cheaper: a few shifts instead of reading the
+ * hardware RNG, and the ranges are scaled with a multiplication instead of a division. The tiny bias
+ * that leaves is invisible on leds.
+ */
+class EffectRandom {
+ public:
+  explicit EffectRandom(uint32_t seed = 0);
+
+  /**
+   * @brief Restart the sequence. Every seed, including 0, gives another sequence.
+   */
+  void seed(uint32_t seed);
+
+  /**
+   * @brief Returns 32 random bits.
+   */
+  uint32_t next() {
+    _state ^= _state << 13;
+    _state ^= _state >> 17;
+    _state ^= _state << 5;
+    return _state;
+  }
+
+  /**
+   * @brief Returns a number in [0, max), 0 when max is 0.
+   */
+  uint32_t below(uint32_t max) {
+    // multiply-shift maps the 32 bits onto the range without a division
+    return static_cast<uint64_t>(next()) * max >> 32;
+  }
+
+  /**
+   * @brief Returns a number in [min, max), min when max is not larger than min. Like Arduino's `random(min, max)`.
+   */
+  int32_t between(int32_t min, int32_t max) {
+    if (max <= min) return min;
+    return min + below(static_cast<uint32_t>(max) - static_cast<uint32_t>(min));
+  }
+
+ private:
+  uint32_t _state;
+};
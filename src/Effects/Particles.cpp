@@ -0,0 +1,105 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "Particles.h"
+
+ParticleSystem::ParticleSystem(size_t capacity) :
+  _capacity(capacity),
+  _size(0),
+  _position(nullptr),
+  _velocity(nullptr),
+  _colour(nullptr),
+  _level(nullptr),
+  _fade(nullptr) {
+    _position = new int32_t[_capacity];
+    _velocity = new int16_t[_capacity];
+    _colour = new Colour[_capacity];
+    _level = new uint16_t[_capacity];
+    _fade = new uint16_t[_capacity];
+  }
+
+ParticleSystem::~ParticleSystem() {
+  delete[] _position;
+  delete[] _velocity;
+  delete[] _colour;
+  delete[] _level;
+  delete[] _fade;
+}
+
+bool ParticleSystem::spawn(int32_t position, int16_t velocity, Colour colour, uint16_t lifetime) {
+  if (_size == _capacity) return false;
+  if (lifetime == 0) lifetime = 1;
+  _position[_size] = position;
+  _velocity[_size] = velocity;
+  _colour[_size] = colour;
+  _level[_size] = 0xFF00;
+  _fade[_size] = (0xFF00 + lifetime - 1) / lifetime;  // rounded up so the particle is gone after lifetime updates
+  ++_size;
+  return true;
+}
+
+void ParticleSystem::update(size_t numLeds, uint16_t steps) {
+  const int32_t end = static_cast<int32_t>(numLeds) << 8;
+  size_t i = 0;
+  while (i < _size) {
+    _position[i] += _velocity[i] * static_cast<int32_t>(steps) >> 8;
+    uint32_t fade = static_cast<uint32_t>(_fade[i]) * steps >> 8;
+    if (_level[i] <= fade || _position[i] < 0 || _position[i] >= end) {
+      _retire(i);  // moves the last particle here, check index i again
+    } else {
+      _level[i] -= fade;
+      ++i;
+    }
+  }
+}
+
+void ParticleSystem::clear() {
+  _size = 0;
+}
+
+size_t ParticleSystem::size() const {
+  return _size;
+}
+
+size_t ParticleSystem::capacity() const {
+  return _capacity;
+}
+
+void ParticleSystem::render(Colour* leds, size_t numLeds) const {
+  for (size_t i = 0; i < _size; ++i) {
+    size_t index = _position[i] >> 8;
+    if (index < numLeds) {
+      leds[index] = addColours(leds[index], scaleColour(_colour[i], _level[i] >> 8));
+    }
+  }
+}
+
+void ParticleSystem::_retire(size_t index) {
+  --_size;
+  _position[index] = _position[_size];
+  _velocity[index] = _velocity[_size];
+  _colour[index] = _colour[_size];
+  _level[index] = _level[_size];
+  _fade[index] = _fade[_size];
+}
@@ -0,0 +1,145 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file Particles.h
+ * @brief Fixed capacity particle system for sparkle-style effects
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Colour.h"
+#include "ColourMath.h"
+
+/**
+ * @brief Fixed capacity particle system.
+ * 
+ * All storage is allocated on construction, spawning and retiring particles doesn't touch the heap.
+ * Particles are stored as separate arrays per property and are kept packed at the front:
+ * a retired particle is replaced by the last one.
+ * 
+ * Positions and velocities are in 1/256 of a led. Every particle fades from full brightness
+ * to zero over its lifetime and is retired when it has faded out or left the strip.
+ */
+class ParticleSystem {
+ public:
+  /**
+   * @brief Create a particle system.
+   * 
+   * @param capacity maximum number of simultaneous particles
+   */
+  explicit ParticleSystem(size_t capacity);
+  ~ParticleSystem();
+  ParticleSystem(const ParticleSystem&) = delete;
+  ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+  /**
+   * @brief Add a particle.
+   * 
+   * @param position position in 1/256 led, eg. `led << 8`
+   * @param velocity movement per update in 1/256 led
+   * @param colour colour at full brightness
+   * @param lifetime number of updates until the particle has faded out, at least 1
+   * @return false when there is no room for another particle
+   */
+  bool spawn(int32_t position, int16_t velocity, Colour colour, uint16_t lifetime);
+
+  /**
+   * @brief Move and fade all particles and retire those that are done.
+   * 
+   * Pass the time since the last update as a fraction of an update to keep the speed of the
+   * particles independent of the frame rate.
+   * 
+   * @param numLeds length of the strip, particles outside are retired
+   * @param steps number of updates in 1/256, defaults to a single update
+   */
+  void update(size_t numLeds, uint16_t steps = 0x100);
+
+  /**
+   * @brief Retire all particles.
+   */
+  void clear();
+
+  /**
+   * @brief Returns the number of live particles.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns the maximum number of particles.
+   */
+  size_t capacity() const;
+
+  /**
+   * @brief Add the particles to a buffer of colours, overlapping particles saturate.
+   * 
+   * @param leds colours to add to
+   * @param numLeds number of colours in the buffer
+   */
+  void render(Colour* leds, size_t numLeds) const;
+
+  /**
+   * @brief Draw the particles on a single colour background.
+   * 
+   * Only the leds with a particle are written. Works on anything with `setPixel(index, colour)`,
+   * eg. a `LedFrame`, so the strip only has to encode the touched leds.
+   * 
+   * @param frame destination
+   * @param background colour the particles fade to
+   */
+  template <class Frame>
+  void render(Frame& frame, Colour background) const {
+    for (size_t i = 0; i < _size; ++i) {
+      frame.setPixel(_position[i] >> 8, lerpColours(background, _colour[i], _level[i] >> 8));
+    }
+  }
+
+  /**
+   * @brief Restore the background where the particles are.
+   * 
+   * Call before `update()` to remove the particles from the previous frame.
+   * 
+   * @param frame destination
+   * @param background colour to restore
+   */
+  template <class Frame>
+  void erase(Frame& frame, Colour background) const {
+    for (size_t i = 0; i < _size; ++i) {
+      frame.setPixel(_position[i] >> 8, background);
+    }
+  }
+
+ private:
+  void _retire(size_t index);
+  const size_t _capacity;
+  size_t _size;
+  int32_t* _position;
+  int16_t* _velocity;
+  Colour* _colour;
+  uint16_t* _level;  // 8.8 fixed point brightness
+  uint16_t* _fade;   // 8.8 fixed point decrease per update
+};
@@ -24,78 +24,46 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "SnowSparkle.h"
 
-const Colour SnowSparkle::Sparkle::_flake(255, 255, 255);
-
-SnowSparkle::Sparkle::Sparkle(SnowSparkle* parent, size_t steps):
-  _parent(parent),
-  _pos(random(_parent->_ledstrip->numLeds())),
-  _step(1),
-  _steps(steps) {}
-
-SnowSparkle::Sparkle::~Sparkle() {
-  _parent->_ledstrip->setPixel(_pos, _parent->_baseColour);
-}
-
-void SnowSparkle::Sparkle::update() {
-  uint8_t red = _flake.red + ((_step / _steps) * (_parent->_baseColour.red - _flake.red));
-  uint8_t green = _flake.green + ((_step / _steps) * (_parent->_baseColour.green - _flake.green));
-  uint8_t blue = _flake.blue + ((_step / _steps) * (_parent->_baseColour.blue - _flake.blue));
-  ++_step;
-  _parent->_ledstrip->setPixel(_pos, red, green, blue);
-}
-
-bool SnowSparkle::Sparkle::finished() const {
-  return (_step > _steps);
-}
+const Colour SnowSparkle::_flake(255, 255, 255);
+const uint32_t SnowSparkle::_stepMs = 20;
 
 SnowSparkle::SnowSparkle(Colour baseColour, size_t nrSparkles, uint32_t minDelay, uint32_t maxDelay) :
   _baseColour(baseColour),
-  _nrSparkles(nrSparkles),
-  _sparkles(nullptr),
-  _lastMillis(millis()),
+  _sparkles(nrSparkles),
+  _lastSpawn(0),
   _minDelay(minDelay),
   _maxDelay(maxDelay),
-  _nextDelay(random(_minDelay, _maxDelay)) {
-    _sparkles = new Sparkle*[_nrSparkles];
-    for (size_t i = 0; i < _nrSparkles; ++i) {
-      _sparkles[i] = nullptr;
-    }
-  }
+  _nextDelay(0),
+  _lastUpdate(0) {}
 
-void SnowSparkle::_setup() {
-  _ledstrip->setAll(_baseColour);
-  _ledstrip->show();
-  delay(10);
+void SnowSparkle::setup(LedFrame& frame) {
+  _sparkles.clear();
+  _lastSpawn = 0;
+  _lastUpdate = 0;
+  _nextDelay = _random.between(_minDelay, _maxDelay);
+  Colour* pixels = frame.pixels();
+  for (size_t i = 0; i < frame.size(); ++i) {
+    pixels[i] = _baseColour;
+  }
 }
 
-void SnowSparkle::_loop() {
-  if (millis() - _lastMillis > _nextDelay) {
-    _lastMillis = millis();
-    _nextDelay = random(_minDelay, _maxDelay);
-    for (size_t i = 0; i < _nrSparkles; ++i) {
-      if (_sparkles[i] == nullptr) {
-        _sparkles[i] = new Sparkle(this, random(50, 200));
-      }
-    }
+void SnowSparkle::render(LedFrame& frame, uint32_t timestamp) {
+  size_t numLeds = frame.size();
+  if (timestamp - _lastSpawn > _nextDelay) {
+    _lastSpawn = timestamp;
+    _nextDelay = _random.between(_minDelay, _maxDelay);
+    while (_sparkles.spawn(_random.below(numLeds) << 8, 0, _flake, _random.between(50, 200))) {}
   }
-  for (size_t i = 0; i < _nrSparkles; ++i) {
-    if (_sparkles[i]) {
-      _sparkles[i]->update();
-      if (_sparkles[i]->finished()) {
-        delete _sparkles[i];
-        _sparkles[i] = nullptr;
-      }
-    }
-  }
-  _ledstrip->show();
-  delay(10);
+  // sparkles fade by one step every _stepMs, whatever the frame rate
+  uint32_t elapsed = timestamp - _lastUpdate;
+  _lastUpdate = timestamp;
+  uint16_t steps = elapsed < 0xFF * _stepMs ? (elapsed << 8) / _stepMs : 0xFFFF;
+  // only the leds with a sparkle are written
+  _sparkles.erase(frame, _baseColour);
+  _sparkles.update(numLeds, steps);
+  _sparkles.render(frame, _baseColour);
 }
 
-void SnowSparkle::_cleanup() {
-  for (size_t i = 0; i < _nrSparkles; ++i) {
-    if (_sparkles[i]) {
-      delete _sparkles[i];
-      _sparkles[i] = nullptr;
-    }
-  }
+void SnowSparkle::cleanup() {
+  _sparkles.clear();
 }
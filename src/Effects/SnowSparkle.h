@@ -29,41 +29,25 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-#include <array>
-
 #include "Effect.h"
 #include "Colour.h"
+#include "Particles.h"
 
 class SnowSparkle : public WS2811Effect {
- private:
-  class Sparkle {
-   public:
-    Sparkle(SnowSparkle* parent, size_t steps);
-    ~Sparkle();
-    void update();
-    bool finished() const;
-
-   private:
-    SnowSparkle* _parent;
-    size_t _pos;
-    size_t _step;
-    float _steps;
-    const static Colour _flake;
-  };
-
  public:
   SnowSparkle(Colour baseColour, size_t nrSparkles, uint32_t minDelay, uint32_t maxDelay);
+  void setup(LedFrame& frame) override;
+  void render(LedFrame& frame, uint32_t timestamp) override;
+  void cleanup() override;
 
  private:
-  void _setup();
-  void _loop();
-  void _cleanup();
-
+  const static Colour _flake;
+  const static uint32_t _stepMs;  // duration of one step of the sparkles
   Colour _baseColour;
-  const size_t _nrSparkles;
-  Sparkle** _sparkles;
-  uint32_t _lastMillis;
+  ParticleSystem _sparkles;
+  uint32_t _lastSpawn;
   uint32_t _minDelay;
   uint32_t _maxDelay;
   uint32_t _nextDelay;
+  uint32_t _lastUpdate;
 };
@@ -0,0 +1,72 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "LedFrame.h"
+
+LedFrame::LedFrame(Colour* pixels, size_t size) :
+  _pixels(pixels),
+  _size(size),
+  _dirtyFirst(SIZE_MAX),
+  _dirtyEnd(0) {}
+
+LedFrame::operator bool() const {
+  return _pixels != nullptr;
+}
+
+Colour* LedFrame::pixels() {
+  if (_pixels) {
+    _dirtyFirst = 0;
+    _dirtyEnd = _size;
+  }
+  return _pixels;
+}
+
+Colour* LedFrame::pixels(size_t first, size_t end) {
+  if (end > _size) end = _size;
+  if (_pixels && first < end) {
+    if (first < _dirtyFirst) _dirtyFirst = first;
+    if (end > _dirtyEnd) _dirtyEnd = end;
+  }
+  return _pixels;
+}
+
+void LedFrame::setPixel(size_t index, Colour colour) {
+  if (_pixels && index < _size) {
+    _pixels[index] = colour;
+    if (index < _dirtyFirst) _dirtyFirst = index;
+    if (index + 1 > _dirtyEnd) _dirtyEnd = index + 1;
+  }
+}
+
+Colour LedFrame::getPixel(size_t index) const {
+  if (_pixels && index < _size) {
+    return _pixels[index];
+  }
+  Colour c;
+  return c;
+}
+
+size_t LedFrame::size() const {
+  return _size;
+}
@@ -0,0 +1,101 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file LedFrame.h
+ * @brief View on a buffer of leds that effects render into
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>  // SIZE_MAX
+
+#include "Effects/Colour.h"
+
+/**
+ * @brief A buffer of leds with tracking of the changed leds.
+ * 
+ * Effects render into a frame. The frame can be the led buffer of a string (see `WS2811::FrameLock`)
+ * or any other buffer, eg. a layer of a `Compositor`.
+ */
+class LedFrame {
+ public:
+  /**
+   * @brief Create a frame on a buffer.
+   * 
+   * @param pixels buffer of leds, nullptr for an invalid frame
+   * @param size number of leds in the buffer
+   */
+  LedFrame(Colour* pixels, size_t size);
+
+  /**
+   * @brief Returns true when the frame holds a buffer.
+   */
+  explicit operator bool() const;
+
+  /**
+   * @brief Returns the raw led buffer, nullptr for an invalid frame.
+   * 
+   * As the frame can't tell which leds are changed through the raw buffer, all leds are
+   * marked as changed. Use `setPixel()` to only change a few leds.
+   */
+  Colour* pixels();
+
+  /**
+   * @brief Returns the raw led buffer and only marks the leds in [first, end) as changed.
+   * 
+   * Only change the leds in the range through the returned buffer.
+   * 
+   * @param first first changed led
+   * @param end led after the last changed led
+   */
+  Colour* pixels(size_t first, size_t end);
+
+  /**
+   * @brief Set the colour of an individual led.
+   * 
+   * @param index position on the string, zero-indexed.
+   * @param colour Colour object holding new colours
+   */
+  void setPixel(size_t index, Colour colour);
+
+  /**
+   * @brief Returns the colour of an individual led.
+   * 
+   * @param index position on the string, zero-indexed.
+   */
+  Colour getPixel(size_t index) const;
+
+  /**
+   * @brief Returns the number of leds in the buffer.
+   */
+  size_t size() const;
+
+ protected:
+  Colour* _pixels;
+  size_t _size;
+  size_t _dirtyFirst;  // range of changed leds [first, end)
+  size_t _dirtyEnd;
+};
@@ -0,0 +1,106 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file LedTiming.h
+ * @brief Bit timing profiles for the supported led chips
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <soc/soc.h>  // APB_CLK_FREQ
+
+/**
+ * @brief Bit timing of a led chip, expressed in RMT ticks.
+ * 
+ * Use `makeLedTiming()` to calculate the ticks from the timing in the datasheet.
+ */
+struct LedTiming {
+  uint8_t clkDiv;       ///< RMT clock divider, ticks are clkDiv / APB_CLK_FREQ seconds
+  uint16_t t0h;         ///< high time of a 0 bit
+  uint16_t t0l;         ///< low time of a 0 bit
+  uint16_t t1h;         ///< high time of a 1 bit
+  uint16_t t1l;         ///< low time of a 1 bit
+  uint16_t resetTicks;  ///< low time after a frame to latch the colours
+  uint32_t resetUs;     ///< low time after a frame to latch the colours, in microseconds
+};
+
+/**
+ * @brief Convert nanoseconds to (rounded) RMT ticks.
+ * 
+ * @param ns duration in nanoseconds
+ * @param clkDiv RMT clock divider
+ */
+constexpr uint16_t nsToRmtTicks(uint32_t ns, uint8_t clkDiv) {
+  return (static_cast<uint64_t>(ns) * (APB_CLK_FREQ / 1000000) / clkDiv + 500) / 1000;
+}
+
+/**
+ * @brief Calculate a timing profile from the durations in the datasheet.
+ * 
+ * An RMT item holds at most 32767 ticks so the reset time is limited to 819us with the default
+ * clock divider.
+ * 
+ * @param t0hNs high time of a 0 bit in nanoseconds
+ * @param t0lNs low time of a 0 bit in nanoseconds
+ * @param t1hNs high time of a 1 bit in nanoseconds
+ * @param t1lNs low time of a 1 bit in nanoseconds
+ * @param resetUs low time to latch the colours in microseconds
+ * @param clkDiv RMT clock divider, defaults to 2 (25ns ticks)
+ */
+constexpr LedTiming makeLedTiming(uint32_t t0hNs, uint32_t t0lNs, uint32_t t1hNs, uint32_t t1lNs,
+                                  uint32_t resetUs, uint8_t clkDiv = 2) {
+  return LedTiming{clkDiv,
+                   nsToRmtTicks(t0hNs, clkDiv),
+                   nsToRmtTicks(t0lNs, clkDiv),
+                   nsToRmtTicks(t1hNs, clkDiv),
+                   nsToRmtTicks(t1lNs, clkDiv),
+                   nsToRmtTicks(resetUs * 1000, clkDiv),
+                   resetUs};
+}
+
+/**
+ * @brief Timing profiles of common led chips.
+ * 
+ * Values are the typical values from the datasheets. The reset times are the minimum
+ * latch times of the current datasheet revisions.
+ */
+namespace LedTimings {
+// Conservative timing, works for WS2811 in high speed mode and WS2812(B) chips.
+// The bits are those of the original encoder. The original 50 tick (5us) terminator was never
+// sent, the 50us reset of this profile is.
+constexpr LedTiming DEFAULT = makeLedTiming(400, 800, 1000, 600, 50, 8);
+constexpr LedTiming WS2811_400KHZ = makeLedTiming(500, 2000, 1200, 1300, 280);
+constexpr LedTiming WS2811_800KHZ = makeLedTiming(250, 1000, 600, 650, 280);
+constexpr LedTiming WS2812B = makeLedTiming(400, 850, 800, 450, 280);
+constexpr LedTiming SK6812 = makeLedTiming(300, 900, 600, 600, 80);
+constexpr LedTiming WS2813 = makeLedTiming(300, 800, 800, 300, 300);
+constexpr LedTiming APA106 = makeLedTiming(350, 1360, 1360, 350, 50);
+
+static_assert(DEFAULT.t1h == 10 && DEFAULT.t1l == 6 && DEFAULT.t0h == 4 && DEFAULT.t0l == 8,
+              "default bit timing has to match the original bit timing");
+static_assert(WS2813.resetTicks < 32768, "reset time doesn't fit in an RMT item");
+}  // namespace LedTimings
@@ -0,0 +1,71 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "OfflineRenderer.h"
+#include "esp32WS2811.h"
+
+OfflineRenderer::OfflineRenderer(Colour* leds, size_t numLeds, uint16_t fps) :
+  _frame(leds, numLeds),
+  _fps(fps ? fps : 1),
+  _effect(nullptr),
+  _frames(0),
+  _timestamp(0) {}
+
+OfflineRenderer::~OfflineRenderer() {
+  stop();
+}
+
+void OfflineRenderer::start(WS2811Effect* effect) {
+  stop();
+  _effect = effect;
+  _frames = 0;
+  _timestamp = 0;
+}
+
+void OfflineRenderer::stop() {
+  if (_effect) _effect->cleanup();
+  _effect = nullptr;
+}
+
+bool OfflineRenderer::renderFrame() {
+  if (!_effect) return false;
+  if (_frames == 0) _effect->setup(_frame);
+  // calculated from the frame number so the rounding doesn't add up
+  _timestamp = static_cast<uint64_t>(_frames) * 1000 / _fps;
+  _effect->render(_frame, _timestamp);
+  ++_frames;
+  return true;
+}
+
+uint32_t OfflineRenderer::frames() const {
+  return _frames;
+}
+
+uint32_t OfflineRenderer::timestamp() const {
+  return _timestamp;
+}
+
+LedFrame& OfflineRenderer::frame() {
+  return _frame;
+}
@@ -0,0 +1,101 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file OfflineRenderer.h
+ * @brief Render effects on a virtual clock, without a string or render task
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "LedFrame.h"
+
+class WS2811Effect;
+
+/**
+ * @brief Renders an effect frame by frame, as fast as the CPU allows.
+ * 
+ * The timestamp advances one frame period per frame, independent of the time it takes to render
+ * the frame. Together with a seeded effect, every run gives the same frames: to pre-compute an
+ * animation, compare the output of an effect with a previous version or benchmark an hour of
+ * content in seconds.
+ */
+class OfflineRenderer {
+ public:
+  /**
+   * @brief Create a renderer that renders into the given buffer.
+   * 
+   * @param leds buffer to render into, not copied
+   * @param numLeds number of leds in the buffer
+   * @param fps frames per second of the virtual clock, defaults to 50
+   */
+  OfflineRenderer(Colour* leds, size_t numLeds, uint16_t fps = 50);
+  ~OfflineRenderer();
+  OfflineRenderer(const OfflineRenderer&) = delete;
+  OfflineRenderer& operator=(const OfflineRenderer&) = delete;
+
+  /**
+   * @brief Start an effect at timestamp 0, a running effect is stopped first.
+   * 
+   * @param effect effect to render, not deleted by the renderer
+   */
+  void start(WS2811Effect* effect);
+
+  /**
+   * @brief Stop the running effect.
+   */
+  void stop();
+
+  /**
+   * @brief Render the next frame. The first frame is rendered at timestamp 0.
+   * 
+   * @return false when no effect is running
+   */
+  bool renderFrame();
+
+  /**
+   * @brief Returns the number of frames rendered since the effect started.
+   */
+  uint32_t frames() const;
+
+  /**
+   * @brief Returns the timestamp of the last frame in ms.
+   */
+  uint32_t timestamp() const;
+
+  /**
+   * @brief Returns the frame holding the rendered leds.
+   */
+  LedFrame& frame();
+
+ private:
+  LedFrame _frame;
+  uint16_t _fps;
+  WS2811Effect* _effect;
+  uint32_t _frames;
+  uint32_t _timestamp;
+};
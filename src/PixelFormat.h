@@ -0,0 +1,111 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file PixelFormat.h
+ * @brief Order of the colour components on the wire
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Effects/Colour.h"
+
+/**
+ * @brief Returns the index of a colour component: 0 for red, 1 for green, 2 for blue and 3 for white.
+ * 
+ * @param component pointer to the component
+ */
+constexpr size_t componentIndex(uint8_t Colour::*component) {
+  return component == &Colour::red ? 0 :
+         component == &Colour::green ? 1 :
+         component == &Colour::blue ? 2 : 3;
+}
+
+/**
+ * @brief Describes in which order the colour components are sent to the leds.
+ * 
+ * The order is resolved at compile time so the encoder doesn't need to look it up for every led.
+ * 
+ * @tparam C0 first component on the wire
+ * @tparam C1 second component on the wire
+ * @tparam C2 third component on the wire
+ * @tparam C3 fourth component on the wire, only used when `SIZE` is 4
+ * @tparam SIZE number of components per led, 3 or 4
+ */
+template <uint8_t Colour::*C0, uint8_t Colour::*C1, uint8_t Colour::*C2, uint8_t Colour::*C3, size_t SIZE>
+struct PixelFormat {
+  static_assert(SIZE == 3 || SIZE == 4, "leds have 3 or 4 colour components");
+  static const size_t BYTES_PER_LED = SIZE;  ///< number of bytes per led
+  static constexpr uint8_t Colour::*COMPONENT0 = C0;  ///< first component on the wire
+  static constexpr uint8_t Colour::*COMPONENT1 = C1;  ///< second component on the wire
+  static constexpr uint8_t Colour::*COMPONENT2 = C2;  ///< third component on the wire
+  static constexpr uint8_t Colour::*COMPONENT3 = C3;  ///< fourth component on the wire
+  static const size_t INDEX0 = componentIndex(C0);    ///< index of the first component
+  static const size_t INDEX1 = componentIndex(C1);    ///< index of the second component
+  static const size_t INDEX2 = componentIndex(C2);    ///< index of the third component
+  static const size_t INDEX3 = componentIndex(C3);    ///< index of the fourth component
+
+  /**
+   * @brief Returns the component which is sent at the given position.
+   * 
+   * @param colour colour of the led
+   * @param index position of the byte within the led
+   */
+  static uint8_t byte(const Colour& colour, size_t index) {
+    switch (index) {
+      case 0: return colour.*C0;
+      case 1: return colour.*C1;
+      case 2: return colour.*C2;
+      default: return colour.*C3;
+    }
+  }
+
+  /**
+   * @brief Returns the component index (see `componentIndex()`) which is sent at the given position.
+   * 
+   * @param index position of the byte within the led
+   */
+  static size_t component(size_t index) {
+    switch (index) {
+      case 0: return INDEX0;
+      case 1: return INDEX1;
+      case 2: return INDEX2;
+      default: return INDEX3;
+    }
+  }
+};
+
+namespace PixelFormats {
+typedef PixelFormat<&Colour::green, &Colour::red, &Colour::blue, &Colour::white, 3> GRB;  ///< WS2811, WS2812(B), ...
+typedef PixelFormat<&Colour::red, &Colour::green, &Colour::blue, &Colour::white, 3> RGB;
+typedef PixelFormat<&Colour::blue, &Colour::red, &Colour::green, &Colour::white, 3> BRG;
+typedef PixelFormat<&Colour::red, &Colour::blue, &Colour::green, &Colour::white, 3> RBG;
+typedef PixelFormat<&Colour::green, &Colour::blue, &Colour::red, &Colour::white, 3> GBR;
+typedef PixelFormat<&Colour::blue, &Colour::green, &Colour::red, &Colour::white, 3> BGR;
+typedef PixelFormat<&Colour::green, &Colour::red, &Colour::blue, &Colour::white, 4> GRBW;  ///< SK6812 RGBW
+typedef PixelFormat<&Colour::red, &Colour::green, &Colour::blue, &Colour::white, 4> RGBW;
+}  // namespace PixelFormats
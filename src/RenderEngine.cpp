@@ -0,0 +1,219 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "RenderEngine.h"
+#include "esp32WS2811.h"
+
+RenderEngine::RenderEngine(WS2811* ws2811) :
+  _ws2811(ws2811),
+  _task(nullptr),
+  _mutex(nullptr),
+  _effect(nullptr),
+  _effectStarted(false),
+  _effectStart(0),
+  _outgoing(nullptr),
+  _outgoingStart(0),
+  _transitionMs(0),
+  _outgoingLeds(nullptr),
+  _incomingLeds(nullptr),
+  _switchPending(false),
+  _nextEffect(nullptr),
+  _nextTransitionMs(0),
+  _framePeriod(pdMS_TO_TICKS(1000 / 50)),
+  _core(tskNO_AFFINITY),
+  _clock(&esp_timer_get_time) {}
+
+RenderEngine::~RenderEngine() {
+  stop();
+  if (_task) vTaskDelete(_task);
+  if (_mutex) vSemaphoreDelete(_mutex);
+  delete[] _outgoingLeds;  // both buffers are a single allocation
+}
+
+void RenderEngine::setFrameRate(uint16_t fps) {
+  if (fps == 0) {
+    log_w("frame rate has to be at least 1");
+    fps = 1;
+  }
+  TickType_t period = pdMS_TO_TICKS(1000 / fps);
+  if (period == 0) {
+    log_w("frame rate limited by tick rate");
+    period = 1;
+  }
+  _framePeriod = period;
+}
+
+void RenderEngine::setCore(BaseType_t core) {
+  if (_task) {
+    log_w("core has to be set before the first effect is started");
+    return;
+  }
+  _core = core;
+}
+
+void RenderEngine::setClock(RenderClock clock) {
+  if (_task) {
+    log_w("clock has to be set before the first effect is started");
+    return;
+  }
+  _clock = clock ? clock : &esp_timer_get_time;
+}
+
+void RenderEngine::reserveTransitions() {
+  if (_outgoingLeds) return;
+  size_t numLeds = _ws2811->numLeds();
+  _outgoingLeds = new Colour[2 * numLeds];
+  _incomingLeds = &_outgoingLeds[numLeds];
+}
+
+void RenderEngine::start(WS2811Effect* effect, uint32_t transitionMs) {
+  if (!_task) {
+    _mutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore((TaskFunction_t)&_handleRender, "renderTask", 2048, this, 1, &_task, _core);
+  }
+  if (transitionMs && !_outgoingLeds) {
+    log_w("transitions have to be enabled before begin()");
+    transitionMs = 0;
+  }
+  if (xTaskGetCurrentTaskHandle() == _task) {
+    _deferSwitch(effect, transitionMs);
+    return;
+  }
+  // the render task holds the mutex while rendering a frame
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  _switchEffect(effect, transitionMs);
+  xSemaphoreGive(_mutex);
+  xTaskNotifyGive(_task);
+}
+
+void RenderEngine::stop() {
+  if (!_mutex) return;
+  if (xTaskGetCurrentTaskHandle() == _task) {
+    _deferSwitch(nullptr, 0);
+    return;
+  }
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  _switchEffect(nullptr, 0);
+  xSemaphoreGive(_mutex);
+}
+
+WS2811Effect* RenderEngine::effect() const {
+  return _effect;
+}
+
+void RenderEngine::_handleRender(RenderEngine* engine) {
+  TickType_t lastWake = xTaskGetTickCount();
+  while (true) {
+    if (!engine->_effect) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // sleep until an effect is started
+      lastWake = xTaskGetTickCount();
+    }
+    engine->_renderFrame();
+    // unlike delay(), the period includes the time to render the frame
+    vTaskDelayUntil(&lastWake, engine->_framePeriod);
+  }
+}
+
+void RenderEngine::_renderFrame() {
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  if (_effect) {
+    int64_t now = _clock();
+    {
+      WS2811::FrameLock frame(_ws2811);
+      if (frame) {
+        if (_transitionMs) {
+          int64_t start = esp_timer_get_time();
+          _renderTransition(frame, now);
+          _ws2811->_addTiming(&WS2811Stats::render, start);
+        } else {
+          if (!_effectStarted) {
+            _effect->setup(frame);
+            _effectStarted = true;
+            _effectStart = now;
+          }
+          int64_t start = esp_timer_get_time();
+          _effect->render(frame, (now - _effectStart) / 1000);
+          _ws2811->_addTiming(&WS2811Stats::render, start);
+        }
+      }
+    }  // release frame before show()
+    _ws2811->show();
+  }
+  if (_switchPending) {
+    _switchPending = false;
+    _switchEffect(_nextEffect, _nextTransitionMs);
+  }
+  xSemaphoreGive(_mutex);
+}
+
+void RenderEngine::_switchEffect(WS2811Effect* effect, uint32_t transitionMs) {
+  // the outgoing effect of a transition has always been set up, the current effect only after its first frame
+  if (_transitionMs && _outgoing) _outgoing->cleanup();  // only the two latest effects take part in a transition
+  _outgoing = nullptr;
+  if (transitionMs) {
+    if (_effectStarted && _effect != effect) {
+      _outgoing = _effect;  // keeps running until the transition is done
+      _outgoingStart = _effectStart;
+    }
+  }
+  if (_effect && _effect != _outgoing && _effectStarted) _effect->cleanup();
+  _transitionMs = transitionMs;
+  _effect = effect;
+  _effectStarted = false;  // setup() runs on the render task, together with the first frame
+}
+
+void RenderEngine::_deferSwitch(WS2811Effect* effect, uint32_t transitionMs) {
+  // called by an effect while it renders, the render task already holds the mutex
+  _switchPending = true;
+  _nextEffect = effect;
+  _nextTransitionMs = transitionMs;
+}
+
+void RenderEngine::_renderTransition(LedFrame& frame, int64_t now) {
+  size_t numLeds = frame.size();
+  LedFrame outgoing(_outgoingLeds, numLeds);
+  LedFrame incoming(_incomingLeds, numLeds);
+  if (!_effectStarted) {
+    // the outgoing effect continues from what is on the leds, the incoming one starts from black
+    memcpy(_outgoingLeds, frame.pixels(), numLeds * sizeof(Colour));
+    for (size_t i = 0; i < numLeds; ++i) {
+      _incomingLeds[i] = Colour();
+    }
+    _effect->setup(incoming);
+    _effectStarted = true;
+    _effectStart = now;
+  }
+  if (_outgoing) _outgoing->render(outgoing, (now - _outgoingStart) / 1000);
+  uint32_t elapsed = (now - _effectStart) / 1000;
+  _effect->render(incoming, elapsed);
+  if (elapsed < _transitionMs) {
+    lerpBuffers(frame.pixels(), _outgoingLeds, _incomingLeds, numLeds, elapsed * 255 / _transitionMs);
+  } else {
+    // the incoming effect continues on the leds with the frame it has rendered so far
+    memcpy(frame.pixels(), _incomingLeds, numLeds * sizeof(Colour));
+    if (_outgoing) _outgoing->cleanup();
+    _outgoing = nullptr;
+    _transitionMs = 0;
+  }
+}
@@ -0,0 +1,147 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file RenderEngine.h
+ * @brief Runs the effect of a string on a fixed frame clock
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include "LedFrame.h"
+
+class WS2811;
+class WS2811Effect;
+
+/**
+ * @brief Time source of the render engine, returns the time in microseconds.
+ */
+typedef int64_t (*RenderClock)();
+
+/**
+ * @brief Renders the effect of a string.
+ * 
+ * Every string owns a render engine. The engine has a single task which is created when the first
+ * effect starts and lives as long as the string. Every frame it calls the effect's `render()` on a
+ * fixed frame clock and calls `show()`. Switching effects doesn't create or delete tasks.
+ */
+class RenderEngine {
+ public:
+  explicit RenderEngine(WS2811* ws2811);
+  ~RenderEngine();
+  RenderEngine(const RenderEngine&) = delete;
+  RenderEngine& operator=(const RenderEngine&) = delete;
+
+  /**
+   * @brief Set the number of frames per second. Can be changed at any time.
+   * 
+   * The frame period is rounded to FreeRTOS ticks.
+   * 
+   * @param fps frames per second, defaults to 50
+   */
+  void setFrameRate(uint16_t fps);
+
+  /**
+   * @brief Pin the render task to a core. Has to be called before the first effect is started.
+   * 
+   * @param core 0 or 1, defaults to tskNO_AFFINITY
+   */
+  void setCore(BaseType_t core);
+
+  /**
+   * @brief Set the time source the timestamps of the effects are taken from. Has to be called before the
+   * first effect is started.
+   * 
+   * Eg. a clock that is synchronised over the network keeps the effects of several controllers in step.
+   * The frames are still paced by the FreeRTOS ticks.
+   * 
+   * @param clock time in microseconds, defaults to `esp_timer_get_time()`
+   */
+  void setClock(RenderClock clock);
+
+  /**
+   * @brief Allocate the buffers for transitions, so starting an effect never allocates.
+   * 
+   * Called from `WS2811::begin()` when transitions are enabled.
+   */
+  void reserveTransitions();
+
+  /**
+   * @brief Start an effect, a running effect is stopped first.
+   * 
+   * With a transition, the running effect keeps running while the output fades over to the new effect.
+   * Both effects render into the buffers of `reserveTransitions()`, without them the effect switches
+   * immediately.
+   * 
+   * Can be called from an effect while it renders, eg. to chain effects: the switch then happens
+   * after the current frame.
+   * 
+   * @param effect effect to render
+   * @param transitionMs duration of the cross-fade in ms, 0 to switch immediately
+   */
+  void start(WS2811Effect* effect, uint32_t transitionMs = 0);
+
+  /**
+   * @brief Stop the running effect. Returns when the current frame is done.
+   * 
+   * When called from an effect while it renders, the effect is stopped after the current frame.
+   */
+  void stop();
+
+  /**
+   * @brief Returns the running effect or nullptr.
+   */
+  WS2811Effect* effect() const;
+
+ private:
+  static void _handleRender(RenderEngine* engine);
+  void _renderFrame();
+  void _renderTransition(LedFrame& frame, int64_t now);
+  void _switchEffect(WS2811Effect* effect, uint32_t transitionMs);
+  void _deferSwitch(WS2811Effect* effect, uint32_t transitionMs);
+  WS2811* _ws2811;
+  TaskHandle_t _task;
+  SemaphoreHandle_t _mutex;
+  WS2811Effect* _effect;
+  bool _effectStarted;
+  int64_t _effectStart;
+  WS2811Effect* _outgoing;  // nullptr fades from the frame that was shown when the transition started
+  int64_t _outgoingStart;
+  uint32_t _transitionMs;   // 0 when no transition is running
+  Colour* _outgoingLeds;
+  Colour* _incomingLeds;
+  bool _switchPending;  // start() or stop() was called from the render task
+  WS2811Effect* _nextEffect;
+  uint32_t _nextTransitionMs;
+  volatile TickType_t _framePeriod;
+  BaseType_t _core;
+  RenderClock _clock;
+};
@@ -0,0 +1,122 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <math.h>  // powf
+
+#include "RmtEncoder.h"
+
+RmtEncoder::RmtEncoder() :
+  _encodeLeds(&RmtEncoder::_encodeLedsAs<PixelFormats::GRB, false>),
+  _encodeLedsDithered(&RmtEncoder::_encodeLedsAs<PixelFormats::GRB, true>),
+  _encodeBytes(&RmtEncoder::_encodeBytesAs<PixelFormats::GRB, false>),
+  _encodeBytesDithered(&RmtEncoder::_encodeBytesAs<PixelFormats::GRB, true>),
+  _bytesPerLed(PixelFormats::GRB::BYTES_PER_LED),
+  _table(nullptr),
+  _componentTables(),
+  _gammaTable(),
+  _brightness(255),
+  _correction(255, 255, 255, 255),
+  _terminator(),
+  _minBitTicks(0) {
+  setGamma(1.0);
+}
+
+RmtEncoder::~RmtEncoder() {
+  delete[] _table;
+}
+
+void RmtEncoder::begin(const LedTiming& timing) {
+  if (!_table) {
+    _table = new rmt_item32_t[256][8];
+  }
+  rmt_item32_t item0;
+  item0.level0    = 1;
+  item0.duration0 = timing.t0h;
+  item0.level1    = 0;
+  item0.duration1 = timing.t0l;
+  rmt_item32_t item1;
+  item1.level0    = 1;
+  item1.duration0 = timing.t1h;
+  item1.level1    = 0;
+  item1.duration1 = timing.t1l;
+  for (size_t value = 0; value < 256; ++value) {
+    // most significant bit first
+    for (size_t bit = 0; bit < 8; ++bit) {
+      _table[value][bit] = (value & (0x80 >> bit)) ? item1 : item0;
+    }
+  }
+  _terminator.level0    = 0;
+  _terminator.duration0 = timing.resetTicks;
+  _terminator.level1    = 0;
+  _terminator.duration1 = 0;
+  _minBitTicks = timing.t0h + timing.t0l;
+  if (timing.t1h + timing.t1l < _minBitTicks) _minBitTicks = timing.t1h + timing.t1l;
+}
+
+void RmtEncoder::setBrightness(uint8_t brightness) {
+  _brightness = brightness;
+  _buildComponentTables();
+}
+
+void RmtEncoder::setGamma(float gamma) {
+  for (size_t value = 0; value < 256; ++value) {
+    _gammaTable[value] = powf(value / 255.0f, gamma) * 255.0f * 256.0f + 0.5f;
+  }
+  _buildComponentTables();
+}
+
+void RmtEncoder::setColourCorrection(Colour correction) {
+  _correction = correction;
+  _buildComponentTables();
+}
+
+void RmtEncoder::_buildComponentTables() {
+  const uint8_t corrections[4] = {_correction.red, _correction.green, _correction.blue, _correction.white};
+  for (size_t component = 0; component < 4; ++component) {
+    // scale 0-256 so full brightness and correction leave the colour unchanged and 0 turns it off
+    uint32_t scale = 0;
+    if (corrections[component] && _brightness) {
+      scale = (corrections[component] + 1) * (_brightness + 1) >> 8;
+    }
+    for (size_t value = 0; value < 256; ++value) {
+      _componentTables[component][value] = (_gammaTable[value] * scale + 0x80) >> 8;
+    }
+  }
+}
+
+size_t RmtEncoder::bytesPerLed() const {
+  return _bytesPerLed;
+}
+
+size_t RmtEncoder::itemsPerLed() const {
+  return _bytesPerLed * 8;
+}
+
+void RmtEncoder::setTerminator(rmt_item32_t* item) const {
+  *item = _terminator;
+}
+
+uint32_t RmtEncoder::minBitTicks() const {
+  return _minBitTicks;
+}
@@ -0,0 +1,234 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file RmtEncoder.h
+ * @brief Lookup table based encoder from colours to RMT items
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>  // memcpy
+
+#include <driver/rmt.h>
+
+#include "Effects/Colour.h"
+#include "LedTiming.h"
+#include "PixelFormat.h"
+
+/**
+ * @brief Encodes colours into RMT items.
+ * 
+ * Every possible byte value is encoded once into its 8 RMT items so encoding a led
+ * is reduced to copying three (or four) blocks of 8 items. The order of the colour components
+ * is set with `setFormat()` and defaults to GRB.
+ * 
+ * Brightness, gamma and colour correction are combined into a lookup table per colour component
+ * which is applied while encoding, so the colours in the led buffer are never changed.
+ */
+class RmtEncoder {
+ public:
+  RmtEncoder();
+  ~RmtEncoder();
+  RmtEncoder(const RmtEncoder&) = delete;
+  RmtEncoder& operator=(const RmtEncoder&) = delete;
+
+  /**
+   * @brief Build the lookup table. Has to be called before encoding.
+   * 
+   * @param timing bit timing of the leds
+   */
+  void begin(const LedTiming& timing = LedTimings::DEFAULT);
+
+  /**
+   * @brief Set the order of the colour components on the wire.
+   * 
+   * @tparam Format one of `PixelFormats`
+   */
+  template <class Format>
+  void setFormat();
+
+  /**
+   * @brief Set the global brightness.
+   * 
+   * @param brightness 0-255, defaults to 255
+   */
+  void setBrightness(uint8_t brightness);
+
+  /**
+   * @brief Set the gamma correction.
+   * 
+   * @param gamma gamma value, defaults to 1.0 (no correction)
+   */
+  void setGamma(float gamma);
+
+  /**
+   * @brief Set the colour correction (white balance).
+   * 
+   * Every component of the correction scales the same component of the leds.
+   * 
+   * @param correction colour correction, defaults to (255, 255, 255, 255)
+   */
+  void setColourCorrection(Colour correction);
+
+  /**
+   * @brief Returns the number of bytes per led.
+   */
+  size_t bytesPerLed() const;
+
+  /**
+   * @brief Returns the number of RMT items per led.
+   */
+  size_t itemsPerLed() const;
+
+  /**
+   * @brief Encode a number of leds.
+   * 
+   * When an error buffer is passed, the fractional part of the corrected colours is
+   * accumulated and added to the next frame (temporal dithering).
+   * 
+   * @param leds colours to encode
+   * @param numLeds number of leds to encode
+   * @param items destination, has to hold `numLeds * itemsPerLed()` items
+   * @param error dithering error, one byte per colour component of the encoded leds, or nullptr
+   */
+  void encode(const Colour* leds, size_t numLeds, rmt_item32_t* items, uint8_t* error = nullptr) const {
+    if (error) {
+      (this->*_encodeLedsDithered)(leds, numLeds, items, error);
+    } else {
+      (this->*_encodeLeds)(leds, numLeds, items, nullptr);
+    }
+  }
+
+  /**
+   * @brief Encode a range of bytes in the order they are sent over the wire.
+   * 
+   * Bytes are counted over the whole string: byte 0 is the first colour component of the
+   * first led that goes out on the wire. Used to encode the leds in chunks.
+   * 
+   * @param leds colours of the whole string
+   * @param firstByte index of the first byte to encode
+   * @param numBytes number of bytes to encode
+   * @param items destination, has to hold `numBytes * 8` items
+   * @param error dithering error of the whole string, one byte per colour component, or nullptr
+   */
+  void encodeBytes(const Colour* leds, size_t firstByte, size_t numBytes, rmt_item32_t* items,
+                   uint8_t* error = nullptr) const {
+    if (error) {
+      (this->*_encodeBytesDithered)(leds, firstByte, numBytes, items, error);
+    } else {
+      (this->*_encodeBytes)(leds, firstByte, numBytes, items, nullptr);
+    }
+  }
+
+  /**
+   * @brief Write the terminating item which latches the colours and ends the transmission.
+   * 
+   * @param item item to write
+   */
+  void setTerminator(rmt_item32_t* item) const;
+
+  /**
+   * @brief Returns the duration of the shortest bit in RMT ticks.
+   */
+  uint32_t minBitTicks() const;
+
+ private:
+  template <bool DITHER>
+  void _encodeByte(size_t component, uint8_t value, uint8_t* error, size_t index, rmt_item32_t* items) const;
+  template <class Format, bool DITHER>
+  void _encodeLedsAs(const Colour* leds, size_t numLeds, rmt_item32_t* items, uint8_t* error) const;
+  template <class Format, bool DITHER>
+  void _encodeBytesAs(const Colour* leds, size_t firstByte, size_t numBytes, rmt_item32_t* items,
+                      uint8_t* error) const;
+  void _buildComponentTables();
+  void (RmtEncoder::*_encodeLeds)(const Colour*, size_t, rmt_item32_t*, uint8_t*) const;
+  void (RmtEncoder::*_encodeLedsDithered)(const Colour*, size_t, rmt_item32_t*, uint8_t*) const;
+  void (RmtEncoder::*_encodeBytes)(const Colour*, size_t, size_t, rmt_item32_t*, uint8_t*) const;
+  void (RmtEncoder::*_encodeBytesDithered)(const Colour*, size_t, size_t, rmt_item32_t*, uint8_t*) const;
+  size_t _bytesPerLed;
+  rmt_item32_t (*_table)[8];
+  uint16_t _componentTables[4][256];  // red, green, blue, white in 8.8 fixed point
+  uint16_t _gammaTable[256];          // 8.8 fixed point
+  uint8_t _brightness;
+  Colour _correction;
+  rmt_item32_t _terminator;
+  uint32_t _minBitTicks;
+};
+
+template <class Format>
+void RmtEncoder::setFormat() {
+  _encodeLeds = &RmtEncoder::_encodeLedsAs<Format, false>;
+  _encodeLedsDithered = &RmtEncoder::_encodeLedsAs<Format, true>;
+  _encodeBytes = &RmtEncoder::_encodeBytesAs<Format, false>;
+  _encodeBytesDithered = &RmtEncoder::_encodeBytesAs<Format, true>;
+  _bytesPerLed = Format::BYTES_PER_LED;
+}
+
+template <bool DITHER>
+void RmtEncoder::_encodeByte(size_t component, uint8_t value, uint8_t* error, size_t index,
+                             rmt_item32_t* items) const {
+  uint16_t level = _componentTables[component][value];
+  uint8_t out;
+  if (DITHER) {  // resolved at compile time
+    // carry the fraction over to the next frame, the integer part rounds up once enough has accumulated
+    uint16_t sum = error[index] + (level & 0xFF);
+    error[index] = sum;
+    out = (level >> 8) + (sum >> 8);
+  } else {
+    out = (level + 0x80) >> 8;
+  }
+  memcpy(items, _table[out], sizeof(_table[0]));
+}
+
+template <class Format, bool DITHER>
+void RmtEncoder::_encodeLedsAs(const Colour* leds, size_t numLeds, rmt_item32_t* items, uint8_t* error) const {
+  for (size_t i = 0; i < numLeds; ++i) {
+    _encodeByte<DITHER>(Format::INDEX0, leds[i].*Format::COMPONENT0, error, 0, &items[0]);
+    _encodeByte<DITHER>(Format::INDEX1, leds[i].*Format::COMPONENT1, error, 1, &items[8]);
+    _encodeByte<DITHER>(Format::INDEX2, leds[i].*Format::COMPONENT2, error, 2, &items[16]);
+    if (Format::BYTES_PER_LED == 4) {  // resolved at compile time
+      _encodeByte<DITHER>(Format::INDEX3, leds[i].*Format::COMPONENT3, error, 3, &items[24]);
+    }
+    items += Format::BYTES_PER_LED * 8;
+    if (DITHER) error += Format::BYTES_PER_LED;
+  }
+}
+
+template <class Format, bool DITHER>
+void RmtEncoder::_encodeBytesAs(const Colour* leds, size_t firstByte, size_t numBytes, rmt_item32_t* items,
+                                uint8_t* error) const {
+  const Colour* led = &leds[firstByte / Format::BYTES_PER_LED];
+  size_t index = firstByte % Format::BYTES_PER_LED;
+  for (size_t i = 0; i < numBytes; ++i) {
+    _encodeByte<DITHER>(Format::component(index), Format::byte(*led, index), error, firstByte + i, items);
+    items += 8;
+    if (++index == Format::BYTES_PER_LED) {
+      index = 0;
+      ++led;
+    }
+  }
+}
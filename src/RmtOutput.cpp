@@ -0,0 +1,95 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <esp32-hal-log.h>
+
+#include "RmtOutput.h"
+
+#if defined __has_include
+#if __has_include(<soc/soc_caps.h>)
+#include <soc/soc_caps.h>  // SOC_RMT_SUPPORT_TX_SYNCHRO
+#endif
+#endif
+
+RmtOutput::RmtOutput() :
+  _channel(RMT_CHANNEL_0),
+  _installed(false) {}
+
+bool RmtOutput::begin(const WS2811OutputConfig& config) {
+  rmt_config_t rmtConfig = {};
+  rmtConfig.rmt_mode                  = RMT_MODE_TX;
+  rmtConfig.channel                   = config.channel;
+  rmtConfig.gpio_num                  = static_cast<gpio_num_t>(config.dataPin);
+  rmtConfig.mem_block_num             = config.memBlocks;
+  rmtConfig.clk_div                   = config.clkDiv;
+  rmtConfig.tx_config.loop_en         = 0;
+  rmtConfig.tx_config.carrier_en      = 0;
+  rmtConfig.tx_config.idle_output_en  = 1;
+  rmtConfig.tx_config.idle_level      = (rmt_idle_level_t)0;
+  rmtConfig.tx_config.carrier_freq_hz = 10000;
+  rmtConfig.tx_config.carrier_level   = (rmt_carrier_level_t)1;
+  rmtConfig.tx_config.carrier_duty_percent = 50;
+  if (rmt_config(&rmtConfig) != ESP_OK || rmt_driver_install(config.channel, 0, 0) != ESP_OK) {
+    log_e("could not install RMT driver on channel %d", static_cast<int>(config.channel));
+    return false;
+  }
+  _channel = config.channel;
+  _installed = true;
+  if (config.translator) {
+    rmt_translator_init(_channel, config.translator);
+  }
+  return true;
+}
+
+void RmtOutput::end() {
+  if (_installed) {
+    rmt_driver_uninstall(_channel);
+    _installed = false;
+  }
+}
+
+void RmtOutput::write(const rmt_item32_t* items, size_t numItems) {
+  // the terminator is sent as well, its zero duration ends the transmission like the driver's own end marker
+  ESP_ERROR_CHECK(rmt_write_items(_channel, items, numItems, 0 /* don't wait */));
+}
+
+void RmtOutput::writeSample(const uint8_t* data, size_t size) {
+  ESP_ERROR_CHECK(rmt_write_sample(_channel, data, size, 0 /* don't wait */));
+}
+
+void RmtOutput::waitDone() {
+  rmt_wait_tx_done(_channel, portMAX_DELAY);
+}
+
+void RmtOutput::addToGroup() {
+  // the classic ESP32 has no transmit synchronisation, WS2811Group starts its channels in sequence
+  #if SOC_RMT_SUPPORT_TX_SYNCHRO
+  rmt_add_channel_to_group(_channel);
+  #endif
+}
+
+WS2811Output* ws2811DefaultOutput(rmt_channel_t channel) {
+  static RmtOutput outputs[RMT_CHANNEL_MAX];
+  return &outputs[channel];
+}
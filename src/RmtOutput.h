@@ -0,0 +1,52 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file RmtOutput.h
+ * @brief Output to the RMT peripheral of the ESP32
+ */
+
+#pragma once
+
+#include <driver/rmt.h>
+
+#include "WS2811Output.h"
+
+/**
+ * @brief Sends the items of a string with the RMT driver.
+ */
+class RmtOutput : public WS2811Output {
+ public:
+  RmtOutput();
+  bool begin(const WS2811OutputConfig& config) override;
+  void end() override;
+  void write(const rmt_item32_t* items, size_t numItems) override;
+  void writeSample(const uint8_t* data, size_t size) override;
+  void waitDone() override;
+  void addToGroup() override;
+
+ private:
+  rmt_channel_t _channel;
+  bool _installed;
+};
@@ -0,0 +1,125 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include "WS2811Group.h"
+
+WS2811Group::WS2811Group() :
+  _rmtTask(nullptr),
+  _strings(),
+  _numStrings(0) {}
+
+WS2811Group::~WS2811Group() {
+  if (_rmtTask) {
+    vTaskDelete(_rmtTask);
+  }
+  for (size_t i = 0; i < _numStrings; ++i) {
+    _strings[i]->_group = nullptr;
+    _strings[i]->_rmtTask = nullptr;
+  }
+}
+
+bool WS2811Group::add(WS2811* ws2811) {
+  if (_rmtTask) {
+    log_w("strings have to be added before begin()");
+    return false;
+  }
+  if (!ws2811 || ws2811->_rmtTask || ws2811->_group) {
+    log_w("string already started or in a group");
+    return false;
+  }
+  if (_numStrings == RMT_CHANNEL_MAX) {
+    log_w("group is full");
+    return false;
+  }
+  _strings[_numStrings++] = ws2811;
+  return true;
+}
+
+void WS2811Group::begin() {
+  if (_rmtTask) {
+    log_w("group already started");
+    return;
+  }
+  // streaming strings only take a second memory block when the next channel is not in the group
+  for (size_t i = 0; i < _numStrings; ++i) {
+    for (size_t j = 0; j < _numStrings; ++j) {
+      if (_strings[i]->_memBlocks == 0 && _strings[j]->_channel == _strings[i]->_channel + 1) {
+        _strings[i]->_memBlocks = 1;
+      }
+    }
+  }
+  size_t numStarted = 0;
+  for (size_t i = 0; i < _numStrings; ++i) {
+    if (_strings[i]->_setup()) {
+      _strings[numStarted++] = _strings[i];
+    } else {
+      log_e("string on channel %d removed from group", static_cast<int>(_strings[i]->_channel));
+    }
+  }
+  _numStrings = numStarted;
+  for (size_t i = 0; i < _numStrings; ++i) {
+    _strings[i]->_output->addToGroup();
+  }
+  xTaskCreate((TaskFunction_t)&_handleRmt, "rmtGroupTask", 2000, this, 1, &_rmtTask);
+  for (size_t i = 0; i < _numStrings; ++i) {
+    _strings[i]->_group = this;
+    _strings[i]->_rmtTask = _rmtTask;  // show() on a string notifies the group
+  }
+}
+
+void WS2811Group::show() {
+  if (!_rmtTask) {
+    log_w("group not started");
+    return;
+  }
+  for (size_t i = 0; i < _numStrings; ++i) {
+    _strings[i]->_queueFrame();
+  }
+  xTaskNotifyGive(_rmtTask);
+}
+
+void WS2811Group::_handleRmt(WS2811Group* group) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // clears all flags, blocks on next call
+    // encode everything first so the channels can be started right after each other
+    size_t numEncoded = 0;
+    while (numEncoded < group->_numStrings && group->_strings[numEncoded]->_encodeFrame()) {
+      ++numEncoded;
+    }
+    if (numEncoded == group->_numStrings) {
+      for (size_t i = 0; i < group->_numStrings; ++i) {
+        group->_strings[i]->_transmitFrame();
+      }
+      for (size_t i = 0; i < group->_numStrings; ++i) {
+        group->_strings[i]->_finishFrame();
+      }
+    } else {
+      log_e("frame of group dropped");
+      // nothing was sent, only release the strings that were encoded
+      for (size_t i = 0; i < numEncoded; ++i) {
+        group->_strings[i]->_releaseFrame();
+      }
+    }
+  }
+}
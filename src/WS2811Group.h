@@ -0,0 +1,91 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file WS2811Group.h
+ * @brief Drive multiple WS2811 strings in parallel
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/rmt.h>
+
+#include "esp32WS2811.h"
+
+class WS2811;
+
+/**
+ * @brief Group of WS2811 strings that are sent out together.
+ * 
+ * All strings in the group are encoded first and then started together, so refreshing the
+ * group takes as long as the longest string instead of the sum of all strings.
+ * 
+ * Only chips with RMT transmit synchronisation (ESP32-S2, S3 and C3) start the channels at the
+ * same moment. The classic ESP32 doesn't have it: the channels are started one after the other
+ * in software, so the strings start a few microseconds apart.
+ */
+class WS2811Group {
+ public:
+  WS2811Group();
+
+  /**
+   * @brief Destroy the group. Has to be destroyed before the strings it holds.
+   */
+  ~WS2811Group();
+
+  /**
+   * @brief Add a string to the group.
+   * 
+   * Has to be called before `begin()`. The string itself may not be started.
+   * 
+   * @param ws2811 string to add
+   * @return true when the string has been added
+   */
+  bool add(WS2811* ws2811);
+
+  /**
+   * @brief Start all the strings in the group.
+   * 
+   * Strings in a group don't have their own RMT task. Calling `show()` on one of the strings
+   * sends out all the strings of the group.
+   */
+  void begin();
+
+  /**
+   * @brief Send the defined colours of all strings to the leds.
+   * 
+   * Every string gets a new frame sequence number, see `WS2811::show()`.
+   */
+  void show();
+
+ private:
+  static void _handleRmt(WS2811Group* group);
+  TaskHandle_t _rmtTask;
+  WS2811* _strings[RMT_CHANNEL_MAX];
+  size_t _numStrings;
+};
@@ -0,0 +1,106 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file WS2811Output.h
+ * @brief Interface to the peripheral that sends out the encoded leds
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <driver/rmt.h>  // rmt_item32_t, sample_to_rmt_t
+
+/**
+ * @brief Settings passed to the output when a string is started.
+ */
+struct WS2811OutputConfig {
+  rmt_channel_t channel;       ///< RMT channel of the string
+  int dataPin;                 ///< GPIO the leds are connected to
+  uint8_t clkDiv;              ///< RMT clock divider of the led timing
+  uint8_t memBlocks;           ///< number of RMT memory blocks
+  sample_to_rmt_t translator;  ///< encodes the leds while sending, only set in streaming mode
+};
+
+/**
+ * @brief Sends out the RMT items of a string.
+ * 
+ * The string encodes the leds into RMT items and hands them to its output. On the ESP32 this is
+ * the RMT peripheral, a host build can capture the items instead. All methods except `begin()`
+ * and `end()` are called from the RMT task of the string or group.
+ */
+class WS2811Output {
+ public:
+  virtual ~WS2811Output() {}
+
+  /**
+   * @brief Prepare the output, called from `WS2811::begin()`.
+   * 
+   * @return true when the output is ready to send
+   */
+  virtual bool begin(const WS2811OutputConfig& config) = 0;
+
+  /**
+   * @brief Release the output, called when the string is destroyed.
+   */
+  virtual void end() = 0;
+
+  /**
+   * @brief Start sending items, returns without waiting.
+   * 
+   * @param items encoded leds, the last item is the terminator: low for the reset time of the leds,
+   * with a zero second duration which ends the transmission
+   * @param numItems number of items, including the terminator
+   */
+  virtual void write(const rmt_item32_t* items, size_t numItems) = 0;
+
+  /**
+   * @brief Start sending raw bytes, they are encoded by the translator. Returns without waiting.
+   * 
+   * @param data first byte of the leds
+   * @param size number of bytes
+   */
+  virtual void writeSample(const uint8_t* data, size_t size) = 0;
+
+  /**
+   * @brief Block until the last write has been sent out.
+   */
+  virtual void waitDone() = 0;
+
+  /**
+   * @brief Start this output together with the other outputs of a group, when supported.
+   */
+  virtual void addToGroup() {}
+};
+
+/**
+ * @brief Returns the output used by strings that were not given one with `WS2811::setOutput()`.
+ * 
+ * Defined by the backend that is linked in: the RMT peripheral on the ESP32.
+ * 
+ * @param channel RMT channel of the string
+ */
+WS2811Output* ws2811DefaultOutput(rmt_channel_t channel);
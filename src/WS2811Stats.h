@@ -0,0 +1,109 @@
+/*
+
+Copyright 2019 Bert Melis
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONDHTTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file WS2811Stats.h
+ * @brief Performance counters of a string
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined __has_include
+#if __has_include(<hal/cpu_hal.h>)
+#include <hal/cpu_hal.h>  // cpu_hal_get_cycle_count
+#define WS2811_HAS_CPU_HAL
+#endif
+#endif
+#ifndef WS2811_HAS_CPU_HAL
+#include <xtensa/hal.h>  // xthal_get_ccount
+#endif
+
+/**
+ * @brief Returns the cycle counter of the current core.
+ * 
+ * The counters of both cores are not in sync, only use it for spans that stay on one core,
+ * eg. in the benchmarks.
+ */
+inline uint32_t ws2811CycleCount() {
+#ifdef WS2811_HAS_CPU_HAL
+  return cpu_hal_get_cycle_count();
+#else
+  return xthal_get_ccount();
+#endif
+}
+
+/**
+ * @brief Distribution of a duration.
+ * 
+ * All durations are in µs. The histogram counts durations below 16µs, 64µs, 256µs, 1ms, 4ms,
+ * 16ms, 65ms and longer.
+ */
+struct WS2811Timing {
+  static const size_t BUCKETS = 8;
+  uint32_t count;                ///< number of measurements
+  uint32_t min;                  ///< shortest duration
+  uint32_t max;                  ///< longest duration
+  uint64_t total;                ///< sum of all durations
+  uint32_t histogram[BUCKETS];   ///< number of measurements per range
+
+  /**
+   * @brief Returns the average duration.
+   */
+  uint32_t average() const {
+    return count ? total / count : 0;
+  }
+
+  /**
+   * @brief Add a measurement.
+   * 
+   * @param us duration in µs
+   */
+  void add(uint32_t us) {
+    if (count == 0 || us < min) min = us;
+    if (us > max) max = us;
+    ++count;
+    total += us;
+    size_t bucket = 0;
+    for (uint32_t range = us >> 4; range && bucket < BUCKETS - 1; range >>= 2) {
+      ++bucket;
+    }
+    ++histogram[bucket];
+  }
+};
+
+/**
+ * @brief Performance counters of a string, see `WS2811::getStats()`.
+ */
+struct WS2811Stats {
+  WS2811Timing render;      ///< time the effect takes to render a frame
+  WS2811Timing lockWait;    ///< time setters and `FrameLock` wait for the led buffer
+  WS2811Timing encode;      ///< time to encode a frame, 0 in streaming mode as encoding happens while sending
+  WS2811Timing transmit;    ///< time to send a frame
+  uint32_t frames;          ///< number of frames sent, including refreshes
+  uint32_t coalesced;       ///< number of `show()` calls that were merged into a later frame
+  uint32_t lockTimeouts;    ///< number of times a lock could not be taken in time
+};
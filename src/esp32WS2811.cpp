@@ -25,70 +25,355 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <string.h>  // memcpy
+
 #include "esp32WS2811.h"
 
-void setItem1(rmt_item32_t* item) {
-  item->level0    = 1;
-  item->duration0 = 10;
-  item->level1    = 0;
-  item->duration1 = 6;
-}
+WS2811* WS2811::_instances[RMT_CHANNEL_MAX] = {nullptr};
 
-void setItem0(rmt_item32_t* item) {
-  item->level0    = 1;
-  item->duration0 = 4;
-  item->level1    = 0;
-  item->duration1 = 8;
-}
+const sample_to_rmt_t WS2811::_translators[RMT_CHANNEL_MAX] = {
+  &WS2811::_translator<0>,
+  &WS2811::_translator<1>,
+  &WS2811::_translator<2>,
+  &WS2811::_translator<3>,
+  &WS2811::_translator<4>,
+  &WS2811::_translator<5>,
+  &WS2811::_translator<6>,
+  &WS2811::_translator<7>
+};
 
-void setTerminator(rmt_item32_t* item) {
-  item->level0    = 0;
-  item->duration0 = 50;
-  item->level1    = 0;
-  item->duration1 = 0;
+WS2811::FrameLock::FrameLock(WS2811* ws2811) :
+  LedFrame(nullptr, ws2811->_numLeds),
+  _ws2811(ws2811) {
+    if (_ws2811->_lock()) {
+      _pixels = _ws2811->_leds;
+    } else {
+      log_e("could not lock frame");
+    }
+  }
+
+WS2811::FrameLock::~FrameLock() {
+  if (_pixels) {
+    _ws2811->_dirty.add(_dirtyFirst, _dirtyEnd);
+    _ws2811->_unlock();
+  }
 }
 
 WS2811::WS2811(int dataPin, size_t numLeds, int channel) :
+  _encoder(),
   _rmtTask(nullptr),
   _smphr(nullptr),
+  _frontSmphr(nullptr),
   _channel(static_cast<rmt_channel_t>(channel)),
   _dataPin(dataPin),
   _numLeds(numLeds),
+  _doubleBuffer(false),
   _leds(nullptr),
-  _effect(nullptr) {
+  _frontLeds(nullptr),
+  _dirty{0, numLeds},  // everything has to be encoded the first time
+  _pending{0, numLeds},
+  _dirtyPixels(0),
+  _timing(LedTimings::DEFAULT),
+  _rmtItems(nullptr),
+  _streaming(false),
+  _memBlocks(0),
+  _output(nullptr),
+  _streamLeds(nullptr),
+  _streamStart(0),
+  _streamEnd(0),
+  _streamRefills(0),
+  _refillNs(0),
+  _underruns(0),
+  _dithering(false),
+  _transitions(false),
+  _swapTimeout(0),
+  _ditherError(nullptr),
+  _refreshTicks(0),
+  _group(nullptr),
+  _frameWaiters(),
+  _queuedSeq(0),
+  _encodedSeq(0),
+  _sentSeq(0),
+  _onFrameDone(),
+  _stats(),
+  _transmitStart(0),
+  _renderEngine(this) {
     _leds = new Colour[_numLeds];
   }
 
 WS2811::~WS2811() {
-  stopEffect();
-  vTaskDelete(_rmtTask);
-  vSemaphoreDelete(_smphr);
+  _renderEngine.stop();
+  if (_rmtTask && !_group) {
+    vTaskDelete(_rmtTask);
+  }
+  if (_instances[_channel] == this) {
+    _output->end();
+    _instances[_channel] = nullptr;
+  }
+  if (_smphr) vSemaphoreDelete(_smphr);
+  if (_frontSmphr) vSemaphoreDelete(_frontSmphr);
+  for (size_t i = 0; i < MAX_FRAME_WAITERS; ++i) {
+    if (_frameWaiters[i].done) vSemaphoreDelete(_frameWaiters[i].done);
+  }
   delete[] _leds;
+  delete[] _frontLeds;
+  delete[] _rmtItems;
+  delete[] _ditherError;
 }
 
 void WS2811::begin() {
-  _setupRMT();
+  if (_rmtTask) {
+    log_w("string already started");
+    return;
+  }
+  if (_setup()) {
+    xTaskCreate((TaskFunction_t)&_handleRmt, "rmtTask", 2000, this, 1, &_rmtTask);
+  }
+}
+
+bool WS2811::_setup() {
+  if (_memBlocks == 0) {
+    // streaming refills the RMT memory while sending, a second block gives the encoder more time
+    bool nextFree = _channel + 1 < RMT_CHANNEL_MAX && !_instances[_channel + 1];
+    _memBlocks = _streaming && nextFree ? 2 : 1;
+  }
+  if (_channel + _memBlocks > RMT_CHANNEL_MAX) {
+    log_w("not enough memory blocks available for this channel");
+    _memBlocks = RMT_CHANNEL_MAX - _channel;
+  }
+  for (size_t i = 0; i < RMT_CHANNEL_MAX; ++i) {
+    const WS2811* other = _instances[i];
+    if (other && _channel < other->_channel + other->_memBlocks && other->_channel < _channel + _memBlocks) {
+      log_e("RMT memory of channel %d is already used by another string", static_cast<int>(_channel));
+      return false;
+    }
+  }
+  _instances[_channel] = this;
+  _encoder.begin(_timing);
+  if (!_setupOutput()) {
+    _instances[_channel] = nullptr;
+    return false;
+  }
+  if (!_streaming) {
+    _rmtItems = new rmt_item32_t[_numLeds * _encoder.itemsPerLed() + 1];
+    _encoder.setTerminator(&_rmtItems[_numLeds * _encoder.itemsPerLed()]);
+  }
+  if (_dithering) {
+    _ditherError = new uint8_t[_numLeds * _encoder.bytesPerLed()]();
+  }
+  if (_transitions) {
+    _renderEngine.reserveTransitions();
+  }
   _smphr = xSemaphoreCreateBinary();
   xSemaphoreGive(_smphr);  // release emaphores for first use
-  xTaskCreate((TaskFunction_t)&_handleRmt, "rmtTask", 2000, this, 1, &_rmtTask);
+  for (size_t i = 0; i < MAX_FRAME_WAITERS; ++i) {
+    _frameWaiters[i].done = xSemaphoreCreateBinary();  // taken until the frame is sent
+  }
+  if (_doubleBuffer) {
+    _frontLeds = new Colour[_numLeds];
+    memcpy(_frontLeds, _leds, _numLeds * sizeof(Colour));
+    _frontSmphr = xSemaphoreCreateBinary();
+    xSemaphoreGive(_frontSmphr);
+  }
+  return true;
 }
 
 size_t WS2811::numLeds() const {
   return _numLeds;
 }
 
-void WS2811::show() {
+void WS2811::setDoubleBuffer(bool enable) {
+  if (_rmtTask) {
+    log_w("double buffering has to be set before begin()");
+    return;
+  }
+  _doubleBuffer = enable;
+}
+
+void WS2811::setTiming(const LedTiming& timing) {
+  if (_rmtTask) {
+    log_w("timing has to be set before begin()");
+    return;
+  }
+  _timing = timing;
+}
+
+void WS2811::setStreaming(bool enable) {
+  if (_rmtTask) {
+    log_w("streaming has to be set before begin()");
+    return;
+  }
+  _streaming = enable;
+}
+
+void WS2811::setMemBlocks(uint8_t blocks) {
+  if (_rmtTask) {
+    log_w("memory blocks have to be set before begin()");
+    return;
+  }
+  if (blocks == 0) {
+    log_w("at least 1 memory block is needed");
+    blocks = 1;
+  }
+  _memBlocks = blocks;
+}
+
+void WS2811::setOutput(WS2811Output* output) {
+  if (_rmtTask) {
+    log_w("output has to be set before begin()");
+    return;
+  }
+  _output = output;
+}
+
+void WS2811::setBrightness(uint8_t brightness) {
+  if (_lockEncoder()) {
+    _encoder.setBrightness(brightness);
+    (_frontLeds ? _pending : _dirty).add(0, _numLeds);
+    _unlockEncoder();
+  } else {
+    log_e("could not set brightness");
+  }
+}
+
+void WS2811::setGamma(float gamma) {
+  if (_lockEncoder()) {
+    _encoder.setGamma(gamma);
+    (_frontLeds ? _pending : _dirty).add(0, _numLeds);
+    _unlockEncoder();
+  } else {
+    log_e("could not set gamma");
+  }
+}
+
+void WS2811::setColourCorrection(Colour correction) {
+  if (_lockEncoder()) {
+    _encoder.setColourCorrection(correction);
+    (_frontLeds ? _pending : _dirty).add(0, _numLeds);
+    _unlockEncoder();
+  } else {
+    log_e("could not set colour correction");
+  }
+}
+
+void WS2811::setDithering(bool enable) {
+  if (_rmtTask) {
+    log_w("dithering has to be set before begin()");
+    return;
+  }
+  _dithering = enable;
+}
+
+void WS2811::setTransitions(bool enable) {
+  if (_rmtTask) {
+    log_w("transitions have to be set before begin()");
+    return;
+  }
+  _transitions = enable;
+}
+
+void WS2811::setRefreshRate(uint16_t hz) {
+  if (_rmtTask) {
+    log_w("refresh rate has to be set before begin()");
+    return;
+  }
+  if (hz == 0) {
+    _refreshTicks = 0;
+    return;
+  }
+  _refreshTicks = pdMS_TO_TICKS(1000 / hz);
+  if (_refreshTicks == 0) {
+    log_w("refresh rate limited by tick rate");
+    _refreshTicks = 1;
+  }
+}
+
+uint32_t WS2811::underruns() const {
+  return _underruns;
+}
+
+size_t WS2811::dirtyPixels() const {
+  return _dirtyPixels;
+}
+
+WS2811Stats WS2811::getStats() const {
+  portENTER_CRITICAL(&_statsMux);
+  WS2811Stats stats = _stats;
+  portEXIT_CRITICAL(&_statsMux);
+  return stats;
+}
+
+void WS2811::resetStats() {
+  portENTER_CRITICAL(&_statsMux);
+  _stats = WS2811Stats();
+  portEXIT_CRITICAL(&_statsMux);
+}
+
+uint32_t WS2811::show() {
+  if (!_rmtTask) {
+    log_w("string not started");
+    return 0;
+  }
+  uint32_t seq = _queueFrame();
   xTaskNotifyGive(_rmtTask);
+  return seq;
+}
+
+bool WS2811::waitForFrame(uint32_t seq, TickType_t timeout) {
+  TimeOut_t timeOut;
+  vTaskSetTimeOutState(&timeOut);
+  while (true) {
+    bool sent = false;
+    int slot = -1;
+    // check and register atomically so the RMT task can't finish the frame in between
+    portENTER_CRITICAL(&_seqMux);
+    if (static_cast<int32_t>(_sentSeq - seq) >= 0) {  // handles wrap around
+      sent = true;
+    } else {
+      for (size_t i = 0; i < MAX_FRAME_WAITERS; ++i) {
+        if (_frameWaiters[i].done && !_frameWaiters[i].waiting) {
+          _frameWaiters[i].waiting = true;
+          _frameWaiters[i].seq = seq;
+          slot = i;
+          break;
+        }
+      }
+    }
+    portEXIT_CRITICAL(&_seqMux);
+    if (sent) return true;
+    if (slot < 0) {
+      if (xTaskCheckForTimeOut(&timeOut, &timeout) == pdTRUE) return false;
+      vTaskDelay(1);  // not started or too many waiters, poll
+      continue;
+    }
+    if (xSemaphoreTake(_frameWaiters[slot].done, timeout) == pdTRUE) return true;
+    portENTER_CRITICAL(&_seqMux);
+    bool given = !_frameWaiters[slot].waiting;  // the frame was sent right after the timeout
+    _frameWaiters[slot].waiting = false;
+    portEXIT_CRITICAL(&_seqMux);
+    // the RMT task is about to give the semaphore, take it so the next waiter doesn't wake up early
+    if (given) xSemaphoreTake(_frameWaiters[slot].done, portMAX_DELAY);
+    return given;
+  }
+}
+
+void WS2811::onFrameDone(std::function<void(uint32_t seq)> callback) {
+  if (_rmtTask) {
+    log_w("frame callback has to be set before begin()");
+    return;
+  }
+  _onFrameDone = callback;
 }
 
 void WS2811::setPixel(size_t index, Colour colour) {
-  if (xSemaphoreTake(_smphr, 100) == pdTRUE) {
+  if (_lock()) {
     if (index < _numLeds) {
       _leds[index] = colour;
+      _dirty.add(index, index + 1);
     } else {
       log_w("setting pixel outside range");
     }
-    xSemaphoreGive(_smphr);
+    _unlock();
   } else {
     log_e("could not set pixel");
   }
@@ -99,6 +384,44 @@ void WS2811::setPixel(size_t index, uint8_t red, uint8_t green, uint8_t blue) {
   setPixel(index, c);
 }
 
+void WS2811::setPixels(size_t start, const Colour* colours, size_t count) {
+  if (start >= _numLeds) {
+    log_w("setting pixels outside range");
+    return;
+  }
+  if (count > _numLeds - start) {
+    log_w("setting pixels outside range");
+    count = _numLeds - start;
+  }
+  if (_lock()) {
+    memcpy(&_leds[start], colours, count * sizeof(Colour));
+    _dirty.add(start, start + count);
+    _unlock();
+  } else {
+    log_e("could not set pixels");
+  }
+}
+
+void WS2811::fill(size_t start, size_t count, Colour colour) {
+  if (start >= _numLeds) {
+    log_w("setting pixels outside range");
+    return;
+  }
+  if (count > _numLeds - start) {
+    log_w("setting pixels outside range");
+    count = _numLeds - start;
+  }
+  if (_lock()) {
+    for (size_t i = start; i < start + count; ++i) {
+      _leds[i] = colour;
+    }
+    _dirty.add(start, start + count);
+    _unlock();
+  } else {
+    log_e("could not set pixels");
+  }
+}
+
 Colour WS2811::getPixel(size_t index) const {
   if (index < _numLeds) {
     return _leds[index];
@@ -108,39 +431,42 @@ Colour WS2811::getPixel(size_t index) const {
 }
 
 void WS2811::setRed(size_t index, uint8_t red) {
-  if (xSemaphoreTake(_smphr, 100) == pdTRUE) {
+  if (_lock()) {
     if (index < _numLeds) {
       _leds[index].red = red;
+      _dirty.add(index, index + 1);
     } else {
       log_w("setting pixel outside range");
     }
-    xSemaphoreGive(_smphr);
+    _unlock();
   } else {
     log_e("could not set pixel");
   }
 }
 
 void WS2811::setGreen(size_t index, uint8_t green) {
-  if (xSemaphoreTake(_smphr, 100) == pdTRUE) {
+  if (_lock()) {
     if (index < _numLeds) {
       _leds[index].green = green;
+      _dirty.add(index, index + 1);
     } else {
       log_w("setting pixel outside range");
     }
-    xSemaphoreGive(_smphr);
+    _unlock();
   } else {
     log_e("could not set pixel");
   }
 }
 
 void WS2811::setBlue(size_t index, uint8_t blue) {
-  if (xSemaphoreTake(_smphr, 100) == pdTRUE) {
+  if (_lock()) {
     if (index < _numLeds) {
       _leds[index].blue = blue;
+      _dirty.add(index, index + 1);
     } else {
       log_w("setting pixel outside range");
     }
-    xSemaphoreGive(_smphr);
+    _unlock();
   } else {
     log_e("could not set pixel");
   }
@@ -152,104 +478,278 @@ void WS2811::clearAll() {
 }
 
 void WS2811::setAll(uint8_t red, uint8_t green, uint8_t blue) {
-  for (size_t i = 0; i < _numLeds; ++i) {
-    setPixel(i, red, green, blue);
-  }
+  Colour c(red, green, blue);
+  fill(0, _numLeds, c);
 }
 
 void WS2811::setAll(Colour colour) {
-  for (size_t i = 0; i < _numLeds; ++i) {
-    setPixel(i, colour);
+  fill(0, _numLeds, colour);
+}
+
+Colour* WS2811::beginFrame() {
+  if (_lock()) {
+    _dirty.add(0, _numLeds);
+    return _leds;
   }
+  log_e("could not lock frame");
+  return nullptr;
 }
 
-void WS2811::startEffect(WS2811Effect* effect) {
+void WS2811::endFrame() {
+  _unlock();
+}
+
+void WS2811::startEffect(WS2811Effect* effect, uint32_t transitionMs) {
   if (!effect) {
     log_w("Empty effect ptr: effect not started");
-    return;  // avoids check for nullptr on each loop
-  }
-  if (_effect) {
-    stopEffect();
+    return;  // avoids check for nullptr on each frame
   }
-  _effect = effect;
-  _effect->start(this);
+  _renderEngine.start(effect, transitionMs);
 }
 
 void WS2811::stopEffect() {
-  if (!_effect) {
+  if (!_renderEngine.effect()) {
     log_w("No effect available: unable to stop");
     return;
   }
-  _effect->stop();
-  _effect = nullptr;
+  _renderEngine.stop();
 }
 
-void WS2811::_setupRMT() {
-  static rmt_config_t config;
-  config.rmt_mode                  = RMT_MODE_TX;
-  config.channel                   = _channel;
-  config.gpio_num                  = static_cast<gpio_num_t>(_dataPin);
-  config.mem_block_num             = 8 - _channel;
-  config.clk_div                   = 8;
-  config.tx_config.loop_en         = 0;
-  config.tx_config.carrier_en      = 0;
-  config.tx_config.idle_output_en  = 1;
-  config.tx_config.idle_level      = (rmt_idle_level_t)0;
-  config.tx_config.carrier_freq_hz = 10000;
-  config.tx_config.carrier_level   = (rmt_carrier_level_t)1;
-  config.tx_config.carrier_duty_percent = 50;
-  rmt_config(&config);
-  rmt_driver_install(_channel, 0, 0);
+void WS2811::setFrameRate(uint16_t fps) {
+  _renderEngine.setFrameRate(fps);
 }
 
-void WS2811::_handleRmt(WS2811* ws2811) {
-  static rmt_item32_t* rmtItems = new rmt_item32_t[ws2811->_numLeds * 24 + 1];
-  static rmt_item32_t* currentItem = &rmtItems[0];
+void WS2811::setRenderCore(BaseType_t core) {
+  _renderEngine.setCore(core);
+}
 
-  while (true) {
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // clears all flags, blocks on next call
-    currentItem = &rmtItems[0];
-    if (xSemaphoreTake(ws2811->_smphr, 100) == pdTRUE) {
-      for (size_t i = 0; i < ws2811->_numLeds; ++i) {
-        uint32_t currentPixel = ws2811->_leds[i].green << 16 |
-                                ws2811->_leds[i].red << 8 |
-                                ws2811->_leds[i].blue;
-        for (int8_t j = 23; j >= 0; --j) {
-          // We have 24 bits of data representing the red, green and blue channels. The value of the
-          // 24 bits to output is in the variable current_pixel.  We now need to stream this value
-          // through RMT in most significant bit first.  To do this, we iterate through each of the 24
-          // bits from MSB to LSB.
-          if (currentPixel & (1 << j)) {
-            setItem1(currentItem);
-          } else {
-            setItem0(currentItem);
-          }
-          ++currentItem;
-        }
+void WS2811::setRenderClock(RenderClock clock) {
+  _renderEngine.setClock(clock);
+}
+
+bool WS2811::_lock() {
+  int64_t start = esp_timer_get_time();
+  bool locked = (xSemaphoreTake(_smphr, pdMS_TO_TICKS(LOCK_TIMEOUT_MS)) == pdTRUE);
+  _addTiming(&WS2811Stats::lockWait, start);
+  if (!locked) _countLockTimeout();
+  return locked;
+}
+
+void WS2811::_unlock() {
+  xSemaphoreGive(_smphr);
+}
+
+bool WS2811::_lockEncoder() {
+  // in double buffered mode, writers use the back buffer so only the front buffer needs locking
+  SemaphoreHandle_t smphr = _frontLeds ? _frontSmphr : _smphr;
+  if (!smphr) return true;  // not started yet
+  if (xSemaphoreTake(smphr, pdMS_TO_TICKS(LOCK_TIMEOUT_MS)) != pdTRUE) {
+    _countLockTimeout();
+    return false;
+  }
+  return true;
+}
+
+void WS2811::_unlockEncoder() {
+  SemaphoreHandle_t smphr = _frontLeds ? _frontSmphr : _smphr;
+  if (smphr) xSemaphoreGive(smphr);
+}
+
+void WS2811::_swapBuffers() {
+  if (!_frontLeds) return;
+  if (_lock()) {
+    // the RMT task holds the front buffer while encoding (and while transmitting in streaming mode)
+    if (xSemaphoreTake(_frontSmphr, _swapTimeout) == pdTRUE) {
+      Colour* leds = _frontLeds;
+      _frontLeds = _leds;
+      _leds = leds;
+      // both buffers only differ in the changed leds, copy them to keep the back buffer in sync
+      if (_dirty.first < _dirty.end) {
+        memcpy(&_leds[_dirty.first], &_frontLeds[_dirty.first], (_dirty.end - _dirty.first) * sizeof(Colour));
       }
-      setTerminator(currentItem);  // Write the RMT terminator.
-      ESP_ERROR_CHECK(rmt_write_items(ws2811->_channel, rmtItems, ws2811->_numLeds * 24, 1 /* wait till done */));
-      xSemaphoreGive(ws2811->_smphr);
+      _pending.add(_dirty.first, _dirty.end);
+      _dirty.clear();
+      xSemaphoreGive(_frontSmphr);
     } else {
-      log_e("could not write RMT data");
+      _countLockTimeout();
+      log_e("could not swap buffers");
     }
+    _unlock();
+  } else {
+    log_e("could not swap buffers");
   }
 }
+void WS2811::_addTiming(WS2811Timing WS2811Stats::*timing, int64_t startUs) {
+  // not the cycle counter: it differs per core and tasks can move to the other core while they wait
+  uint32_t us = esp_timer_get_time() - startUs;
+  portENTER_CRITICAL(&_statsMux);
+  (_stats.*timing).add(us);
+  portEXIT_CRITICAL(&_statsMux);
+}
 
-/*
-void WS2811::_handleEffect(WS2811* ws2811) {
+void WS2811::_countLockTimeout() {
+  portENTER_CRITICAL(&_statsMux);
+  ++_stats.lockTimeouts;
+  portEXIT_CRITICAL(&_statsMux);
+}
+
+uint32_t WS2811::_queueFrame() {
+  _swapBuffers();
+  // only count the frame after the swap so a finished frame always contains the swapped buffer
+  portENTER_CRITICAL(&_seqMux);
+  uint32_t seq = ++_queuedSeq;
+  portEXIT_CRITICAL(&_seqMux);
+  return seq;
+}
+
+bool WS2811::_setupOutput() {
+  if (!_output) _output = ws2811DefaultOutput(_channel);
+  WS2811OutputConfig config = {_channel, _dataPin, _timing.clkDiv, _memBlocks, nullptr};
+  _swapTimeout = pdMS_TO_TICKS(LOCK_TIMEOUT_MS);
+  if (_streaming) {
+    // the RMT driver refills half of the memory at a time
+    uint32_t tickNs = 1000 * _timing.clkDiv / (APB_CLK_FREQ / 1000000);
+    _refillNs = _memBlocks * 64 / 2 * _encoder.minBitTicks() * tickNs;
+    config.translator = _translators[_channel];
+    // show() waits for the frame that is being sent, which can take longer than the lock timeout
+    uint32_t bitTicks = _timing.t0h + _timing.t0l > _timing.t1h + _timing.t1l ? _timing.t0h + _timing.t0l
+                                                                            : _timing.t1h + _timing.t1l;
+    uint64_t frameUs = static_cast<uint64_t>(_numLeds) * _encoder.itemsPerLed() * bitTicks * tickNs / 1000 +
+                       _timing.resetUs;
+    _swapTimeout += pdMS_TO_TICKS(frameUs / 1000 + 1);
+  }
+  return _output->begin(config);
+}
+
+template <int CHANNEL>
+void WS2811::_translator(const void* src, rmt_item32_t* dest, size_t srcSize,
+                         size_t wantedNum, size_t* translatedSize, size_t* itemNum) {
+  // the RMT driver doesn't pass any context so every channel gets its own translator
+  _instances[CHANNEL]->_translate(src, dest, srcSize, wantedNum, translatedSize, itemNum);
+}
+
+void WS2811::_translate(const void* src, rmt_item32_t* dest, size_t srcSize,
+                        size_t wantedNum, size_t* translatedSize, size_t* itemNum) {
+  int64_t now = esp_timer_get_time();
+  if (_streamRefills == 0) {
+    _streamStart = now;  // first fill, transmission starts right after
+  } else {
+    // refill n is triggered when n halves have been sent and has to be done before the next half is sent
+    int64_t late = now - _streamStart - static_cast<int64_t>(_streamRefills) * _refillNs / 1000;
+    if (late > _refillNs / 1000) {
+      ++_underruns;
+    }
+  }
+  ++_streamRefills;
+  size_t numBytes = wantedNum / 8;
+  if (numBytes > srcSize) numBytes = srcSize;
+  // the driver only advances src so it tells how many bytes have been sent already
+  size_t firstByte = static_cast<const uint8_t*>(src) - reinterpret_cast<const uint8_t*>(_streamLeds);
+  _encoder.encodeBytes(_streamLeds, firstByte, numBytes, dest, _ditherError);
+  *translatedSize = numBytes;
+  *itemNum = numBytes * 8;
+}
+
+void WS2811::_handleRmt(WS2811* ws2811) {
+  TickType_t lastFrame = xTaskGetTickCount();
   while (true) {
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // clears all flags, blocks on next call
-    ws2811->_runEffect = true;
-    ws2811->_effect->setup(ws2811, ws2811->_numLeds);
-    while (true) {
-      ws2811->_effect->run(ws2811, ws2811->_numLeds);
-      if (xSemaphoreTake(ws2811->_effectSmphr, 0) == pdTRUE) {
-        xSemaphoreGive(ws2811->_effectSmphr);  // prevent stopping on next effect
-        ws2811->_runEffect = false;
-        break;
-      }
+    TickType_t wait = portMAX_DELAY;
+    if (ws2811->_refreshTicks) {
+      // resend the last frame when show() isn't called in time
+      TickType_t elapsed = xTaskGetTickCount() - lastFrame;
+      wait = elapsed < ws2811->_refreshTicks ? ws2811->_refreshTicks - elapsed : 0;
+    }
+    ulTaskNotifyTake(pdTRUE, wait);  // clears all flags, blocks on next call
+    lastFrame = xTaskGetTickCount();
+    if (ws2811->_encodeFrame()) {
+      ws2811->_transmitFrame();
+      ws2811->_finishFrame();
     }
   }
 }
-*/
+
+bool WS2811::_encodeFrame() {
+  if (!_lockEncoder()) {
+    log_e("could not write RMT data");
+    return false;
+  }
+  int64_t start = esp_timer_get_time();
+  portENTER_CRITICAL(&_seqMux);
+  // show() only notifies the RMT task, frames queued while it was busy are sent as one
+  uint32_t coalesced = _queuedSeq - _encodedSeq > 1 ? _queuedSeq - _encodedSeq - 1 : 0;
+  _encodedSeq = _queuedSeq;
+  portEXIT_CRITICAL(&_seqMux);
+  if (coalesced) {
+    portENTER_CRITICAL(&_statsMux);
+    _stats.coalesced += coalesced;
+    portEXIT_CRITICAL(&_statsMux);
+  }
+  const Colour* leds = _frontLeds ? _frontLeds : _leds;
+  DirtyRange& dirty = _frontLeds ? _pending : _dirty;
+  if (_streaming) {
+    // leds are encoded by the translator while transmitting so keep the buffer locked
+    _streamLeds = leds;
+    _streamRefills = 0;
+    _dirtyPixels = _numLeds;
+    dirty.clear();
+  } else {
+    // _rmtItems keeps the previous frame so only the changed leds have to be encoded
+    if (_ditherError) dirty.add(0, _numLeds);  // unless the dithering changes every led
+    if (dirty.first < dirty.end) {
+      _encoder.encode(&leds[dirty.first], dirty.end - dirty.first,
+                      &_rmtItems[dirty.first * _encoder.itemsPerLed()], _ditherError);
+      _dirtyPixels = dirty.end - dirty.first;
+    } else {
+      _dirtyPixels = 0;
+    }
+    dirty.clear();
+    _addTiming(&WS2811Stats::encode, start);
+    _unlockEncoder();  // _rmtItems is private to the RMT task, no need to lock while transmitting
+  }
+  return true;
+}
+
+void WS2811::_transmitFrame() {
+  if (_streaming) {
+    // the driver doesn't send a terminator in streaming mode, respect the reset time here
+    int64_t wait = _streamEnd + _timing.resetUs - esp_timer_get_time();
+    if (wait > 0) delayMicroseconds(static_cast<uint32_t>(wait));
+    _transmitStart = esp_timer_get_time();
+    _output->writeSample(reinterpret_cast<const uint8_t*>(_streamLeds), _numLeds * _encoder.bytesPerLed());
+  } else {
+    _transmitStart = esp_timer_get_time();
+    // including the terminator, which holds the line low for the reset time
+    _output->write(_rmtItems, _numLeds * _encoder.itemsPerLed() + 1);
+  }
+}
+
+void WS2811::_finishFrame() {
+  _output->waitDone();
+  _addTiming(&WS2811Stats::transmit, _transmitStart);
+  portENTER_CRITICAL(&_statsMux);
+  ++_stats.frames;
+  portEXIT_CRITICAL(&_statsMux);
+  if (_streaming) _streamEnd = esp_timer_get_time();
+  _releaseFrame();
+  SemaphoreHandle_t waiters[MAX_FRAME_WAITERS];
+  size_t numWaiters = 0;
+  portENTER_CRITICAL(&_seqMux);
+  bool newFrame = _sentSeq != _encodedSeq;  // false when the previous frame is refreshed
+  _sentSeq = _encodedSeq;
+  for (size_t i = 0; i < MAX_FRAME_WAITERS; ++i) {
+    if (_frameWaiters[i].waiting && static_cast<int32_t>(_sentSeq - _frameWaiters[i].seq) >= 0) {
+      waiters[numWaiters++] = _frameWaiters[i].done;
+      _frameWaiters[i].waiting = false;
+    }
+  }
+  portEXIT_CRITICAL(&_seqMux);
+  for (size_t i = 0; i < numWaiters; ++i) {
+    xSemaphoreGive(waiters[i]);
+  }
+  if (_onFrameDone && newFrame) _onFrameDone(_sentSeq);
+}
+
+void WS2811::_releaseFrame() {
+  // in streaming mode the leds stay locked for the translator until the frame is sent or dropped
+  if (_streaming) _unlockEncoder();
+}
@@ -38,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 // General
 #include <stddef.h>
+#include <stdint.h>  // SIZE_MAX
 #include <functional>
 
 // ESP-IDF
@@ -46,21 +47,62 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <freertos/semphr.h>
 #include <driver/rmt.h>
 #include <driver/gpio.h>
+#include <soc/soc.h>  // APB_CLK_FREQ
+#include <esp_timer.h>
 
 // Arduino framework
 #include <esp32-hal-log.h>
+#include <esp32-hal.h>  // delayMicroseconds
 
 // Internal
 #include "Effects/Colour.h"  // Colour definition
-#include "Effects/Effect.h"  // includes all builtin effects
+#include "Effects/ColourMath.h"
+#include "Effects/Particles.h"
+#include "LedFrame.h"
+#include "LedTiming.h"
+#include "PixelFormat.h"
+#include "RmtEncoder.h"
+#include "WS2811Output.h"
+#include "RenderEngine.h"
+#include "OfflineRenderer.h"
+#include "WS2811Stats.h"
+#include "WS2811Group.h"
 
 class WS2811Effect;
+class WS2811Group;
 
 /**
  * @brief Create a string of ws2811 leds.
  */
 class WS2811 {
  public:
+  /**
+   * @brief Scoped access to the led buffer.
+   * 
+   * The buffer is locked once on construction and released on destruction so a full frame
+   * can be written without locking for every pixel. Always check whether the lock succeeded
+   * before writing and release the lock before calling `show()`.
+   */
+  class FrameLock : public LedFrame {
+   public:
+    /**
+     * @brief Lock the led buffer of the given string.
+     * 
+     * @param ws2811 string to lock
+     */
+    explicit FrameLock(WS2811* ws2811);
+
+    /**
+     * @brief Release the led buffer, the changed leds are encoded on the next `show()`.
+     */
+    ~FrameLock();
+    FrameLock(const FrameLock&) = delete;
+    FrameLock& operator=(const FrameLock&) = delete;
+
+   private:
+    WS2811* _ws2811;
+  };
+
   /**
    * @brief Create a string of ws2811 leds.
    * 
@@ -75,9 +117,155 @@ class WS2811 {
   /**
    * @brief Start the WS2811 string, turns off all the leds on this string and waits for 
    * further input.
+   * 
+   * Every string runs its own RMT task so multiple strings can be used at the same time, as long
+   * as their RMT channels and memory blocks don't overlap. A string which conflicts with a string
+   * that is already started will not start.
    */
   void begin();
 
+  /**
+   * @brief Enable or disable double buffering.
+   * 
+   * With double buffering, the setters always write to a back buffer while the RMT task
+   * encodes the front buffer. `show()` swaps both buffers so writers never have to wait for
+   * the previous frame to be encoded or transmitted. This costs an extra `sizeof(Colour)`
+   * (4) bytes per led. Has to be called before `begin()`.
+   * 
+   * In streaming mode the front buffer is in use until the frame has been sent: the setters
+   * still don't block but `show()` waits for the previous frame to be sent.
+   * 
+   * @param enable true to enable double buffering, defaults to disabled
+   */
+  void setDoubleBuffer(bool enable);
+
+  /**
+   * @brief Set the bit timing of the leds.
+   * 
+   * Pick the profile of your led chip from `LedTimings` or create your own with `makeLedTiming()`.
+   * Chips that support tighter timing give a higher refresh rate. Has to be called before `begin()`.
+   * 
+   * @param timing timing profile, defaults to `LedTimings::DEFAULT`
+   */
+  void setTiming(const LedTiming& timing);
+
+  /**
+   * @brief Enable or disable streaming output.
+   * 
+   * In streaming mode, the leds are encoded on the fly into the RMT memory while transmitting
+   * instead of into a buffer holding the whole string. Memory use then no longer depends on the
+   * number of leds but the led buffer stays locked while transmitting: combine with double
+   * buffering to keep the setters from blocking, `show()` then still waits for the previous frame
+   * to be sent. Has to be called before `begin()`.
+   * 
+   * @param enable true to enable streaming output, defaults to disabled
+   */
+  void setStreaming(bool enable);
+
+  /**
+   * @brief Set the number of RMT memory blocks used by this string.
+   * 
+   * Every block holds 64 items. A channel uses the blocks following its own block so a channel
+   * with more than one block takes away the memory of the next channel(s). More blocks mean less
+   * refills while transmitting. Has to be called before `begin()`.
+   * 
+   * @param blocks number of memory blocks, defaults to 1. In streaming mode 2 when the next channel
+   * is not used by another string.
+   */
+  void setMemBlocks(uint8_t blocks);
+
+  /**
+   * @brief Send the leds to another output than the RMT peripheral.
+   * 
+   * The output is not deleted by the string. Has to be called before `begin()`.
+   * 
+   * @param output output to use, nullptr for the default RMT output
+   */
+  void setOutput(WS2811Output* output);
+
+  /**
+   * @brief Set the global brightness. Can be changed at any time.
+   * 
+   * Brightness, gamma and colour correction are applied while encoding, the colours
+   * of the leds are not changed. A change is sent with the next `show()`.
+   * 
+   * @param brightness 0-255, defaults to 255
+   */
+  void setBrightness(uint8_t brightness);
+
+  /**
+   * @brief Set the gamma correction. Can be changed at any time.
+   * 
+   * @param gamma gamma value, defaults to 1.0 (no correction). 2.2 is a good starting point.
+   */
+  void setGamma(float gamma);
+
+  /**
+   * @brief Set the colour correction (white balance). Can be changed at any time.
+   * 
+   * @param correction scale of every colour component, defaults to (255, 255, 255, 255)
+   */
+  void setColourCorrection(Colour correction);
+
+  /**
+   * @brief Enable temporal dithering. Has to be called before `begin()`.
+   * 
+   * The fraction that is lost when brightness, gamma and colour correction are applied is
+   * carried over to the next frames so dimmed leds get levels in between the 8 bit steps.
+   * Every frame is encoded completely. Use together with `setRefreshRate()`.
+   * 
+   * @param enable true to enable dithering, defaults to false
+   */
+  void setDithering(bool enable);
+
+  /**
+   * @brief Enable cross-fades between effects. Has to be called before `begin()`.
+   * 
+   * The two buffers the effects render into during a transition are allocated by `begin()`, so
+   * `startEffect()` never allocates. This costs an extra 2 * `sizeof(Colour)` (8) bytes per led.
+   * 
+   * @param enable true to enable transitions, defaults to false
+   */
+  void setTransitions(bool enable);
+
+  /**
+   * @brief Retransmit the last frame at a fixed rate, without calling `show()`. Has to be called before `begin()`.
+   * 
+   * The rate is limited by the FreeRTOS tick rate and the time to send a frame.
+   * Not used when the string is part of a `WS2811Group`.
+   * 
+   * @param hz refreshes per second, defaults to 0 (only send on `show()`)
+   */
+  void setRefreshRate(uint16_t hz);
+
+  /**
+   * @brief Returns the number of refills that came too late in streaming mode.
+   * 
+   * A late refill, eg. due to high interrupt load, sends stale data to the leds.
+   */
+  uint32_t underruns() const;
+
+  /**
+   * @brief Returns the number of leds that were encoded for the last frame.
+   * 
+   * In buffered mode, only the range of leds that changed since the previous frame is encoded.
+   * In streaming mode, every frame is encoded completely.
+   */
+  size_t dirtyPixels() const;
+
+  /**
+   * @brief Returns the performance counters of the string.
+   * 
+   * The counters are kept with `esp_timer_get_time()` and are cheap enough to leave on.
+   * Can be called from any task.
+   */
+  WS2811Stats getStats() const;
+
+  /**
+   * @brief Reset all performance counters.
+   */
+  void resetStats();
+
   /**
    * @brief Returns the number of leds.
    */
@@ -90,8 +278,38 @@ class WS2811 {
    * sends them over the DATA line. By calling `show()`, the memory which holds the led's 
    * colours will be unaccessable for a very short moment to be able to copy the data to 
    * the RMT driver without errors.
+   * When double buffering is enabled, `show()` only swaps the front and back buffer and
+   * copies the new front buffer into the back buffer so you can continue where you left off.
+   * 
+   * `show()` doesn't wait for the frame to be sent. When called faster than frames can be sent,
+   * the new colours are sent together in the next frame.
+   * 
+   * @return sequence number of the frame, to be used with `waitForFrame()`
+   */
+  uint32_t show();
+
+  /**
+   * @brief Wait until a frame has been sent to the leds.
+   * 
+   * Returns when the frame with the given sequence number, or a later one, has been
+   * completely sent. At most 4 tasks wait on a semaphore of the string, more are polled every tick.
+   * The task notification of the calling task is not used.
+   * 
+   * @param seq sequence number returned by `show()`
+   * @param timeout maximum time to wait, in ticks
+   * @return true when the frame has been sent, false on timeout
    */
-  void show();
+  bool waitForFrame(uint32_t seq, TickType_t timeout = portMAX_DELAY);
+
+  /**
+   * @brief Set a callback which is called every time a frame has been sent to the leds.
+   * 
+   * The callback runs in the RMT task and receives the sequence number of the frame. Keep it short.
+   * Has to be called before `begin()`.
+   * 
+   * @param callback function to call
+   */
+  void onFrameDone(std::function<void(uint32_t seq)> callback);
 
   /**
    * @brief Set the colour of an individual led.
@@ -117,6 +335,30 @@ class WS2811 {
    */
   void setPixel(size_t index, uint8_t red, uint8_t green, uint8_t blue);
 
+  /**
+   * @brief Set the colour of a range of leds.
+   * 
+   * Call `show()` to actually send the new colours to the leds. The buffer is only locked once
+   * for the whole range. Leds outside the string are ignored.
+   * 
+   * @param start position of the first led on the string, zero-indexed.
+   * @param colours array of at least `count` colours
+   * @param count number of leds to set
+   */
+  void setPixels(size_t start, const Colour* colours, size_t count);
+
+  /**
+   * @brief Set a range of leds to the same colour.
+   * 
+   * Call `show()` to actually send the new colours to the leds. The buffer is only locked once
+   * for the whole range. Leds outside the string are ignored.
+   * 
+   * @param start position of the first led on the string, zero-indexed.
+   * @param count number of leds to set
+   * @param colour Colour object
+   */
+  void fill(size_t start, size_t count, Colour colour);
+
   /**
    * @brief Get the colour of an individual led.
    * 
@@ -190,33 +432,173 @@ class WS2811 {
    */
   void setAll(Colour colour);
 
+  /**
+   * @brief Lock the led buffer for direct access.
+   * 
+   * Returns the raw led buffer of `numLeds()` colours or nullptr when the buffer could not be
+   * locked. All leds will be encoded again on the next `show()`. Every successful call has to be matched by `endFrame()`, before calling `show()`.
+   * Prefer `FrameLock` which does this automatically.
+   * 
+   * @return pointer to the led buffer
+   */
+  Colour* beginFrame();
+
+  /**
+   * @brief Release the led buffer locked by `beginFrame()`.
+   */
+  void endFrame();
+
   /**
    * @brief Starts an effect
    * 
-   * You first have to stop a running effect before starting a new one.
+   * A running effect is stopped first, or at the end of the transition. The effect is rendered by the
+   * render engine of the string, which calls `show()` for every frame.
    * The lib does not delete the WS2811Effect object.
    * 
    * @param effect Pointer to an effect
+   * @param transitionMs duration of the cross-fade from the running effect in ms, defaults to 0 (no cross-fade).
+   * Needs `setTransitions()`.
    */
-  void startEffect(WS2811Effect* effect);
+  void startEffect(WS2811Effect* effect, uint32_t transitionMs = 0);
 
   /**
    * @brief Stops an effect
    * 
-   * This methods stops a running effect. While this call return immideately, the effect only stops after
-   * it's `run` functions returns.
+   * Returns when the frame that is being rendered is done, the effect can be deleted afterwards.
    * The lib does not delete the stopped WS2811Effect object.
    */
   void stopEffect();
 
+  /**
+   * @brief Set the number of frames per second for effects. Can be changed at any time.
+   * 
+   * @param fps frames per second, defaults to 50
+   */
+  void setFrameRate(uint16_t fps);
+
+  /**
+   * @brief Pin the render task to a core. Has to be called before the first effect is started.
+   * 
+   * @param core 0 or 1, defaults to no affinity
+   */
+  void setRenderCore(BaseType_t core);
+
+  /**
+   * @brief Set the time source of the effects. Has to be called before the first effect is started.
+   * 
+   * @param clock returns the time in microseconds, defaults to `esp_timer_get_time()`
+   */
+  void setRenderClock(RenderClock clock);
+
+ protected:
+  RmtEncoder _encoder;
+
  private:
-  void _setupRMT();
+  friend class WS2811Group;
+  friend class RenderEngine;
+  struct DirtyRange {
+    size_t first;
+    size_t end;
+    void add(size_t rangeFirst, size_t rangeEnd) {
+      if (rangeFirst < first) first = rangeFirst;
+      if (rangeEnd > end) end = rangeEnd;
+    }
+    void clear() {
+      first = SIZE_MAX;
+      end = 0;
+    }
+  };
+  bool _setup();
+  bool _setupOutput();
+  bool _lock();
+  void _unlock();
+  bool _lockEncoder();
+  void _unlockEncoder();
+  void _swapBuffers();
+  void _addTiming(WS2811Timing WS2811Stats::*timing, int64_t startUs);
+  void _countLockTimeout();
+  uint32_t _queueFrame();
+  bool _encodeFrame();
+  void _transmitFrame();
+  void _finishFrame();
+  void _releaseFrame();
   static void _handleRmt(WS2811* ws2811);
+  template <int CHANNEL>
+  static void _translator(const void* src, rmt_item32_t* dest, size_t srcSize,
+                          size_t wantedNum, size_t* translatedSize, size_t* itemNum);
+  void _translate(const void* src, rmt_item32_t* dest, size_t srcSize,
+                  size_t wantedNum, size_t* translatedSize, size_t* itemNum);
+  static WS2811* _instances[RMT_CHANNEL_MAX];
+  static const sample_to_rmt_t _translators[RMT_CHANNEL_MAX];
   TaskHandle_t _rmtTask;
   SemaphoreHandle_t _smphr;
+  SemaphoreHandle_t _frontSmphr;
   rmt_channel_t _channel;
   int _dataPin;
   size_t _numLeds;
+  bool _doubleBuffer;
   Colour* _leds;
-  WS2811Effect* _effect;
+  Colour* _frontLeds;
+  DirtyRange _dirty;    // changed leds in the buffer that is written to
+  DirtyRange _pending;  // changed leds in the front buffer that are not encoded yet
+  size_t _dirtyPixels;
+  LedTiming _timing;
+  rmt_item32_t* _rmtItems;
+  bool _streaming;
+  uint8_t _memBlocks;  // 0 until begin() when not set
+  WS2811Output* _output;
+  const Colour* _streamLeds;
+  int64_t _streamStart;
+  int64_t _streamEnd;
+  uint32_t _streamRefills;
+  uint32_t _refillNs;
+  volatile uint32_t _underruns;
+  bool _dithering;
+  bool _transitions;
+  TickType_t _swapTimeout;
+  uint8_t* _ditherError;
+  TickType_t _refreshTicks;
+  WS2811Group* _group;
+  static const uint32_t LOCK_TIMEOUT_MS = 100;
+  static const size_t MAX_FRAME_WAITERS = 4;
+  struct {
+    SemaphoreHandle_t done;  // given by the RMT task, the task notification of the waiter is left alone
+    uint32_t seq;
+    bool waiting;
+  } _frameWaiters[MAX_FRAME_WAITERS];
+  portMUX_TYPE _seqMux = portMUX_INITIALIZER_UNLOCKED;
+  uint32_t _queuedSeq;
+  uint32_t _encodedSeq;
+  uint32_t _sentSeq;
+  std::function<void(uint32_t seq)> _onFrameDone;
+  WS2811Stats _stats;
+  mutable portMUX_TYPE _statsMux = portMUX_INITIALIZER_UNLOCKED;
+  int64_t _transmitStart;
+  RenderEngine _renderEngine;
+};
+
+/**
+ * @brief Create a string of leds with a specific colour order.
+ * 
+ * `WS2811` sends the colours in GRB order. Use this class for leds with another colour order
+ * or with a white channel, eg. `WS2811Strip<PixelFormats::GRBW> strip(18, 60);` for SK6812 RGBW leds.
+ * 
+ * @tparam Format one of `PixelFormats`
+ */
+template <class Format>
+class WS2811Strip : public WS2811 {
+ public:
+  /**
+   * @brief Create a string of leds.
+   * 
+   * @param dataPin pin number connected to DATA line of the leds
+   * @param numLeds number of leds on the string
+   * @param channel RMT channel to use, defaults to channel 0
+   */
+  explicit WS2811Strip(int dataPin, size_t numLeds, int channel = RMT_CHANNEL_0) :
+    WS2811(dataPin, numLeds, channel) {
+      _encoder.template setFormat<Format>();
+    }
 };
+
+#include "Effects/Effect.h"  // includes all builtin effects